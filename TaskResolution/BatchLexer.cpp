@@ -0,0 +1,156 @@
+#include "BatchLexer.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+namespace fs = std::filesystem;
+
+namespace {
+    // 文件列表和单个源文件按给出的路径命名，而不只取文件名，不同目录下的同名文件不会写到同一个输出文件；
+    // 去掉盘符和开头的/，..换成__，输出文件总在输出目录之内
+    std::string outputName(const std::string& path) {
+        std::string name;
+        for (const auto& part : fs::path(path).lexically_normal().relative_path()) {
+            std::string piece = part.generic_string();
+            if (piece.empty() || piece == ".") continue;
+            if (piece == "..") piece = "__";
+            if (!name.empty()) name += '/';
+            name += piece;
+        }
+        return name;
+    }
+}
+
+BatchLexer::BatchLexer(const CompiledLexer& lexer, BatchOptions options)
+    : lexer(lexer), options(std::move(options)) {}
+
+std::vector<BatchSource> BatchLexer::collectSources(const std::vector<std::string>& inputs) {
+    std::vector<BatchSource> sources;
+    for (const auto& input : inputs) {
+        // 文件列表：每行一个源文件路径
+        if (!input.empty() && input[0] == '@') {
+            std::ifstream list(input.substr(1));
+            if (!list.is_open()) {
+                std::cerr << "无法打开文件列表: " << input.substr(1) << std::endl;
+                continue;
+            }
+            std::string line;
+            while (std::getline(list, line)) {
+                if (!line.empty() && line.back() == '\r') line.pop_back();
+                if (line.empty()) continue;
+                sources.push_back({line, outputName(line)});
+            }
+            continue;
+        }
+
+        std::error_code ec;
+        if (fs::is_directory(input, ec)) {
+            std::vector<BatchSource> found;
+            for (const auto& entry : fs::recursive_directory_iterator(input, ec)) {
+                if (!entry.is_regular_file()) continue;
+                found.push_back({entry.path().string(),
+                                 fs::relative(entry.path(), input).generic_string()});
+            }
+            // 目录遍历顺序与平台有关，排序后保证输出顺序稳定
+            std::sort(found.begin(), found.end(),
+                      [](const BatchSource& a, const BatchSource& b) { return a.name < b.name; });
+            sources.insert(sources.end(), found.begin(), found.end());
+        } else {
+            sources.push_back({input, outputName(input)});
+        }
+    }
+    return sources;
+}
+
+bool BatchLexer::run(const std::vector<BatchSource>& sources) const {
+    // 两个源文件的输出名相同时会有两个工作线程同时写同一个文件，在开始之前报错
+    std::vector<const BatchSource*> byName;
+    for (const auto& source : sources) byName.push_back(&source);
+    std::sort(byName.begin(), byName.end(), [](const BatchSource* a, const BatchSource* b) { return a->name < b->name; });
+    for (size_t i = 1; i < byName.size(); i++) {
+        if (byName[i]->name == byName[i - 1]->name) {
+            std::cerr << "输出名重复: " << byName[i - 1]->path << " 与 " << byName[i]->path
+                      << " 都对应 " << byName[i]->name << std::endl;
+            return false;
+        }
+    }
+
+    std::ofstream columnar;
+    if (!options.columnar_file.empty()) {
+        columnar.open(options.columnar_file);
+        if (!columnar.is_open()) {
+            std::cerr << "无法创建输出文件: " << options.columnar_file << std::endl;
+            return false;
+        }
+        columnar << "file\tline\tcolumn\ttype\tvalue\n";
+    }
+
+    // 按源文件顺序写出合并流：先完成的文件暂存，等前面的文件都写出后再写
+    std::mutex output_mutex;
+    std::vector<std::string> pending_output(sources.size());
+    std::vector<char> finished(sources.size(), 0);
+    size_t next_to_write = 0;
+    std::atomic<size_t> failures{0};
+
+    // jobs为0时使用硬件线程数；ThreadPool本身会把0当作1个线程
+    unsigned jobs = options.jobs != 0 ? options.jobs : std::max(1u, std::thread::hardware_concurrency());
+    ThreadPool pool(jobs);
+    for (size_t index = 0; index < sources.size(); index++) {
+        pool.submit([&, index] {
+            const BatchSource& source = sources[index];
+            std::string rows;
+            try {
+                std::string code = LexicalAnalysis::readSourceFile(source.path);
+                std::vector<Token> tokens = LexicalScanner(lexer, code).scanAll();
+                LineIndex lines(code);
+
+                if (!options.output_dir.empty()) {
+                    fs::path target = fs::path(options.output_dir) / (source.name + ".tokens");
+                    std::error_code ec;
+                    fs::create_directories(target.parent_path(), ec);
+                    std::ofstream out(target);
+                    if (!out.is_open()) {
+                        throw std::runtime_error("Could not create output file " + target.string());
+                    }
+                    LexicalAnalysis::printTokens(tokens, lines, out);
+                }
+
+                if (columnar.is_open()) {
+                    std::ostringstream stream;
+                    for (const auto& token : tokens) {
+                        stream << source.name << '\t' << lines.line(token.offset) << '\t'
+                               << lines.column(token.offset) << '\t'
+                               << LexicalAnalysis::tokenTypeName(token.type) << '\t'
+                               << token.value << '\n';
+                    }
+                    rows = stream.str();
+                }
+            } catch (const std::exception& e) {
+                failures.fetch_add(1, std::memory_order_relaxed);
+                std::lock_guard<std::mutex> lock(output_mutex);
+                std::cerr << source.path << ": " << e.what() << std::endl;
+            }
+
+            if (!columnar.is_open()) return;
+            std::lock_guard<std::mutex> lock(output_mutex);
+            pending_output[index] = std::move(rows);
+            finished[index] = 1;
+            while (next_to_write < sources.size() && finished[next_to_write]) {
+                columnar << pending_output[next_to_write];
+                std::string().swap(pending_output[next_to_write]);
+                next_to_write++;
+            }
+        });
+    }
+    pool.wait();
+
+    std::cout << "批量分析完成: " << sources.size() << " 个文件, "
+              << failures.load() << " 个失败" << std::endl;
+    return failures.load() == 0;
+}
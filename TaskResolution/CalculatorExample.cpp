@@ -0,0 +1,71 @@
+#include "SyntaxAnalyzer.h"
+#include "SemanticActions.h"
+#include "LexicalAnalyzer.h"
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+// 用SemanticActions对grammar_6.txt（grammar_3加上%bind）的算术表达式求值
+// 用法：CalculatorExample [输入文件] [变量=值]...，没有给出值的变量为0
+int main(int argc, char* argv[]) {
+    std::string inputPath = "../TestCase/Task2Case/input_6_1.txt";
+    std::map<std::string, double> variables;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        size_t equals = arg.find('=');
+        if (equals == std::string::npos) {
+            inputPath = arg;
+            continue;
+        }
+        try {
+            variables[arg.substr(0, equals)] = std::stod(arg.substr(equals + 1));
+        } catch (const std::exception&) {
+            std::cerr << "Error: Invalid variable value " << arg << std::endl;
+            return 1;
+        }
+    }
+
+    SyntaxAnalyzer analyzer;
+    if (!analyzer.loadGrammar("../TestCase/Task2Case/grammar_6.txt")) {
+        std::cerr << "Failed to load grammar_6.txt file!" << std::endl;
+        return 1;
+    }
+    std::cout << std::endl;
+
+    std::ifstream source_file(inputPath);
+    if (!source_file.is_open()) {
+        std::cerr << "Error: Could not open source code file " << inputPath << std::endl;
+        return 1;
+    }
+    std::string source_code((std::istreambuf_iterator<char>(source_file)),
+                            std::istreambuf_iterator<char>());
+    std::vector<Token> lexical_tokens = LexicalAnalyzer::analyze(source_code);
+    LexicalAnalyzer::processTokens(lexical_tokens);
+    std::vector<TokenInfo> syntax_tokens;
+    for (const auto& token : lexical_tokens) {
+        syntax_tokens.push_back({token.type, token.value, token.line_number});
+    }
+
+    // 产生式编号按文法文件中的顺序，0号为增广产生式；E -> T等单个符号的产生式取右部的值，不必登记
+    SemanticActions<double> actions(analyzer.parseTableView().productionCount);
+    actions.onToken([](const TokenInfo& token, void* user) {
+        if (token.type == CONSTANT) return std::stod(token.value);
+        auto& values = *static_cast<std::map<std::string, double>*>(user);
+        auto found = values.find(token.value);
+        return found != values.end() ? found->second : 0.0;
+    });
+    actions.on(1, [](std::span<double> v, void*) { return v[0] + v[2]; });  // E -> E + T
+    actions.on(2, [](std::span<double> v, void*) { return v[0] - v[2]; });  // E -> E - T
+    actions.on(4, [](std::span<double> v, void*) { return v[0] * v[2]; });  // T -> T * F
+    actions.on(5, [](std::span<double> v, void*) { return v[0] / v[2]; });  // T -> T / F
+    actions.on(7, [](std::span<double> v, void*) { return v[1]; });         // F -> ( E )
+
+    if (!actions.run(analyzer, syntax_tokens, &variables)) {
+        std::cout << "表达式有语法错误" << std::endl;
+        return 1;
+    }
+    std::cout << source_code << " = " << actions.result() << std::endl;
+    return 0;
+}
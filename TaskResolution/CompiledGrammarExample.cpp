@@ -0,0 +1,74 @@
+#include "CompiledGrammar.h"
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// 龙书4.7节的文法，分析表在编译期构造
+using ExampleGrammar = CompiledGrammar<"S -> B B\nB -> a B\nB -> b">;
+constexpr const ParseTableView& table = ExampleGrammar::table;
+
+// 与loadGrammar构造的规范LR(1)分析表逐项相同：终结符 a=0, b=1, #=2，非终结符 B=3, S=4, S'=5（统一编号）
+static_assert(ExampleGrammar::sizes.stateCount == 10);
+static_assert(ExampleGrammar::conflictCount == 0);
+static_assert(table.terminalCount == 3 && table.nonTerminalCount == 3 && table.productionCount == 4);
+static_assert(table.endMarker == 2 && table.symbolName(3) == "B" && table.symbolName(4) == "S");
+static_assert(table.findTerminal("a") == 0 && table.findTerminal("b") == 1 && table.findTerminal("#") == -1);
+static_assert(table.actionAt(0, 0) == LRAction::shift(3) && table.actionAt(0, 1) == LRAction::shift(4));
+static_assert(table.gotoAt(0, 0) == 2 && table.gotoAt(0, 1) == 1 && table.gotoAt(0, 2) == -1);
+static_assert(table.actionAt(1, 2) == LRAction::ACCEPT && table.actionAt(1, 0) == LRAction::ERROR);
+static_assert(table.actionAt(2, 0) == LRAction::shift(6) && table.gotoAt(2, 0) == 5);
+static_assert(table.actionAt(4, 0) == LRAction::reduce(3) && table.actionAt(4, 2) == LRAction::ERROR);
+static_assert(table.actionAt(5, 2) == LRAction::reduce(1));
+static_assert(table.actionAt(7, 2) == LRAction::reduce(3) && table.actionAt(9, 2) == LRAction::reduce(2));
+
+// 最简单的LR驱动：sentence为以空格分隔的终结符名，返回是否接受；分析表是常量，整个分析可以在编译期完成
+constexpr bool accepts(const ParseTableView& grammar, std::string_view sentence) {
+    std::vector<int> input;
+    while (!sentence.empty()) {
+        size_t end = sentence.find(' ');
+        std::string_view word = sentence.substr(0, end);
+        sentence = end == std::string_view::npos ? std::string_view() : sentence.substr(end + 1);
+        if (word.empty()) continue;
+        int terminal = grammar.findTerminal(word);
+        if (terminal < 0) return false;
+        input.push_back(terminal);
+    }
+    input.push_back(grammar.endMarker);
+
+    std::vector<int> stateStack = {0};
+    size_t position = 0;
+    while (true) {
+        int32_t action = grammar.actionAt(stateStack.back(), input[position]);
+        if (action == LRAction::ACCEPT) return true;
+        if (LRAction::isShift(action)) {
+            stateStack.push_back(LRAction::shiftTarget(action));
+            position++;
+        } else if (LRAction::isReduce(action)) {
+            int production = LRAction::reduceProduction(action);
+            stateStack.resize(stateStack.size() - grammar.productionLength[production]);
+            int target = grammar.gotoAt(stateStack.back(), grammar.productionLeft[production]);
+            if (target < 0) return false;
+            stateStack.push_back(target);
+        } else {
+            return false;
+        }
+    }
+}
+
+static_assert(accepts(table, "b b"));
+static_assert(accepts(table, "a b a a b"));
+static_assert(!accepts(table, "a b"));
+static_assert(!accepts(table, "b b b"));
+
+// 用编译期构造的分析表分析命令行给出的句子
+int main(int argc, char* argv[]) {
+    std::string sentence;
+    for (int i = 1; i < argc; i++) {
+        if (i > 1) sentence += ' ';
+        sentence += argv[i];
+    }
+    if (sentence.empty()) sentence = "a b a a b";
+    std::cout << "\"" << sentence << "\": " << (accepts(table, sentence) ? "接受" : "拒绝") << std::endl;
+    return 0;
+}
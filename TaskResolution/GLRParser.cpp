@@ -0,0 +1,332 @@
+#include "GLRParser.h"
+#include <algorithm>
+
+void MultiActionTable::add(int state, int terminal, int32_t action) {
+    size_t cell = static_cast<size_t>(state) * columns + terminal;
+    conflicted[cell] = 1;
+    std::vector<int32_t>& actions = cells[static_cast<uint32_t>(cell)];
+    if (std::find(actions.begin(), actions.end(), action) == actions.end()) actions.push_back(action);
+}
+
+bool SharedPackedForest::addFamily(uint32_t node, int production, std::span<const uint32_t> childNodes) {
+    for (uint32_t index = nodes[node].firstFamily; index != NONE; index = families[index].next) {
+        const PackedNode& existing = families[index];
+        if (existing.production == production && std::ranges::equal(childrenOf(existing), childNodes)) return false;
+    }
+    families.push_back({production, static_cast<uint32_t>(children.size()), static_cast<uint32_t>(childNodes.size()),
+                        nodes[node].firstFamily});
+    children.insert(children.end(), childNodes.begin(), childNodes.end());
+    nodes[node].firstFamily = static_cast<uint32_t>(families.size() - 1);
+    nodes[node].familyCount++;
+    return true;
+}
+
+size_t SharedPackedForest::ambiguousNodeCount() const {
+    return static_cast<size_t>(std::ranges::count_if(nodes, [](const ForestNode& node) { return node.familyCount > 1; }));
+}
+
+uint64_t SharedPackedForest::derivationCount() const {
+    if (empty()) return 0;
+    // 自底向上求每个结点的推导数；环（A =>+ A）意味着无穷多种推导，与溢出一样取UINT64_MAX
+    auto saturatingAdd = [](uint64_t a, uint64_t b) { return a > UINT64_MAX - b ? UINT64_MAX : a + b; };
+    auto saturatingMultiply = [](uint64_t a, uint64_t b) {
+        return a != 0 && b > UINT64_MAX / a ? UINT64_MAX : a * b;
+    };
+    std::vector<uint64_t> count(nodes.size(), 0);
+    std::vector<char> mark(nodes.size(), 0);  // 0未访问，1在栈中，2已求出
+    std::vector<uint32_t> stack = {rootNode};
+    while (!stack.empty()) {
+        uint32_t current = stack.back();
+        if (mark[current] == 2) {
+            stack.pop_back();
+            continue;
+        }
+        if (mark[current] == 0) {
+            mark[current] = 1;
+            for (uint32_t index = nodes[current].firstFamily; index != NONE; index = families[index].next) {
+                for (uint32_t child : childrenOf(families[index])) {
+                    if (mark[child] == 0) stack.push_back(child);
+                    else if (mark[child] == 1) count[child] = UINT64_MAX;
+                }
+            }
+            continue;
+        }
+        stack.pop_back();
+        mark[current] = 2;
+        if (nodes[current].familyCount == 0) {
+            count[current] = 1;
+            continue;
+        }
+        uint64_t total = 0;
+        for (uint32_t index = nodes[current].firstFamily; index != NONE; index = families[index].next) {
+            uint64_t product = 1;
+            for (uint32_t child : childrenOf(families[index])) product = saturatingMultiply(product, count[child]);
+            total = saturatingAdd(total, product);
+        }
+        count[current] = count[current] == UINT64_MAX ? UINT64_MAX : total;
+    }
+    return count[rootNode];
+}
+
+void SharedPackedForest::print(std::ostream& out, const ParseTableView& table, std::span<const std::string> tokenValues) const {
+    if (empty()) return;
+
+    auto productionText = [&table](int production) {
+        std::string text(table.nonTerminalName(table.productionLeft[production]));
+        text += " ->";
+        for (uint32_t k = table.productionRightOffsets[production]; k < table.productionRightOffsets[production + 1]; k++) {
+            text += " ";
+            text += table.symbolName(table.productionRight[k]);
+        }
+        return text;
+    };
+
+    // 先序遍历；条目要么是符号结点，要么是歧义结点下的一种推导
+    struct Pending {
+        uint32_t node;
+        int depth;
+        uint32_t family;  // 不为NONE时打印这一种推导
+        int alternative;
+    };
+    std::vector<char> printed(nodes.size(), 0);
+    std::vector<Pending> pending = {{rootNode, 0, NONE, 0}};
+    auto pushChildren = [&](const PackedNode& packed, int depth) {
+        std::span<const uint32_t> childNodes = childrenOf(packed);
+        for (size_t k = childNodes.size(); k-- > 0;) pending.push_back({childNodes[k], depth, NONE, 0});
+    };
+    while (!pending.empty()) {
+        Pending current = pending.back();
+        pending.pop_back();
+        std::string indent(static_cast<size_t>(current.depth) * 2, ' ');
+        if (current.family != NONE) {
+            out << indent << "候选" << current.alternative << ": " << productionText(families[current.family].production) << "\n";
+            pushChildren(families[current.family], current.depth + 1);
+            continue;
+        }
+
+        const ForestNode& node = nodes[current.node];
+        out << indent << table.symbolName(node.symbol);
+        if (node.familyCount == 0 && node.symbol < table.terminalCount) {
+            if (node.start < tokenValues.size() && tokenValues[node.start] != table.symbolName(node.symbol)) {
+                out << " '" << tokenValues[node.start] << "'";
+            }
+            out << "\n";
+            continue;
+        }
+        out << " [" << node.start << ", " << node.end << ")";
+        if (printed[current.node]) {
+            out << " (共享，见上文)\n";
+            continue;
+        }
+        printed[current.node] = 1;
+        if (node.familyCount == 1) {
+            out << (families[node.firstFamily].childCount == 0 ? " -> ε\n" : "\n");
+            pushChildren(families[node.firstFamily], current.depth + 1);
+            continue;
+        }
+        out << " 歧义: " << node.familyCount << "种推导\n";
+        // 打包结点按添加的逆序链接，照链表顺序入栈，出栈时正好按添加的顺序打印
+        int alternative = 0;
+        size_t base = pending.size();
+        for (uint32_t index = node.firstFamily; index != NONE; index = families[index].next) {
+            pending.push_back({current.node, current.depth + 1, index, 0});
+        }
+        for (size_t k = pending.size(); k-- > base;) pending[k].alternative = ++alternative;
+    }
+}
+
+std::span<const int32_t> GLRParser::actionsOf(int state, int terminal, int32_t& single) const {
+    if (multi.isConflicted(state, terminal)) return multi.actionsAt(state, terminal);
+    single = table.actionAt(state, terminal);
+    if (single == LRAction::ERROR) return {};
+    return {&single, 1};
+}
+
+uint32_t GLRParser::findNode(int state) const {
+    for (uint32_t node : frontier) {
+        if (stackNodes[node].state == state) return node;
+    }
+    return SharedPackedForest::NONE;
+}
+
+uint32_t GLRParser::newNode(int state, uint32_t level) {
+    stackNodes.push_back({state, level, SharedPackedForest::NONE});
+    return static_cast<uint32_t>(stackNodes.size() - 1);
+}
+
+uint32_t GLRParser::addEdge(uint32_t from, uint32_t to, uint32_t forestNode) {
+    stackEdges.push_back({to, forestNode, stackNodes[from].firstEdge});
+    stackNodes[from].firstEdge = static_cast<uint32_t>(stackEdges.size() - 1);
+    return stackNodes[from].firstEdge;
+}
+
+bool GLRParser::hasEdge(uint32_t from, uint32_t to) const {
+    for (uint32_t edge = stackNodes[from].firstEdge; edge != SharedPackedForest::NONE; edge = stackEdges[edge].next) {
+        if (stackEdges[edge].target == to) return true;
+    }
+    return false;
+}
+
+uint32_t GLRParser::symbolNode(SharedPackedForest& forest, int symbol, uint32_t start, uint32_t end) {
+    // 同一位置结束的非终结符结点通常只有几个，顺序查找即可
+    for (uint32_t node : levelSymbols) {
+        if (forest.node(node).symbol == symbol && forest.node(node).start == start) return node;
+    }
+    uint32_t node = forest.addNode(symbol, start, end);
+    levelSymbols.push_back(node);
+    return node;
+}
+
+void GLRParser::enqueueReductions(uint32_t node, int terminal, uint32_t requiredEdge, bool nonEmptyOnly) {
+    int32_t single;
+    for (int32_t action : actionsOf(stackNodes[node].state, terminal, single)) {
+        if (!LRAction::isReduce(action)) continue;
+        int production = LRAction::reduceProduction(action);
+        if (nonEmptyOnly && table.productionLength[production] == 0) continue;
+        pending.push_back({node, production, requiredEdge});
+    }
+}
+
+bool GLRParser::reduceDeterministic(uint32_t node, int production, uint32_t position, SharedPackedForest& forest) {
+    // 只有一个栈顶、表项没有冲突、归约路径唯一时，与LR分析一样直接归约，归约前的栈顶不再有其他动作
+    int length = table.productionLength[production];
+    pathSymbols.resize(static_cast<size_t>(length));
+    uint32_t bottom = node;
+    for (int k = length - 1; k >= 0; k--) {
+        uint32_t edge = stackNodes[bottom].firstEdge;
+        if (edge == SharedPackedForest::NONE || stackEdges[edge].next != SharedPackedForest::NONE) return false;
+        pathSymbols[static_cast<size_t>(k)] = stackEdges[edge].forestNode;
+        bottom = stackEdges[edge].target;
+    }
+    int left = table.productionLeft[production];
+    int target = table.gotoAt(stackNodes[bottom].state, left);
+    if (target < 0 || findNode(target) != SharedPackedForest::NONE) return false;
+
+    uint32_t symbol = symbolNode(forest, table.terminalCount + left, stackNodes[bottom].level, position);
+    forest.addFamily(symbol, production, pathSymbols);
+    uint32_t top = newNode(target, position);
+    addEdge(top, bottom, symbol);
+    frontier[0] = top;
+    return true;
+}
+
+void GLRParser::reduceAll(int terminal, uint32_t position, SharedPackedForest& forest) {
+    pending.clear();
+    for (size_t k = 0, count = frontier.size(); k < count; k++) enqueueReductions(frontier[k], terminal, SharedPackedForest::NONE, false);
+
+    std::vector<uint32_t> childNodes;
+    while (!pending.empty()) {
+        Reduction reduction = pending.back();
+        pending.pop_back();
+        int length = table.productionLength[reduction.production];
+        int left = table.productionLeft[reduction.production];
+        childNodes.assign(static_cast<size_t>(length), 0);
+
+        // 枚举从栈顶出发、长为length的全部路径；收集完再处理，处理时添加的边不影响这次枚举
+        std::vector<std::pair<uint32_t, std::vector<uint32_t>>> paths;
+        auto walk = [&](auto&& self, uint32_t node, int remaining, bool usedRequired) -> void {
+            if (remaining == 0) {
+                if (reduction.requiredEdge == SharedPackedForest::NONE || usedRequired) paths.emplace_back(node, childNodes);
+                return;
+            }
+            for (uint32_t edge = stackNodes[node].firstEdge; edge != SharedPackedForest::NONE; edge = stackEdges[edge].next) {
+                childNodes[static_cast<size_t>(remaining - 1)] = stackEdges[edge].forestNode;
+                self(self, stackEdges[edge].target, remaining - 1, usedRequired || edge == reduction.requiredEdge);
+            }
+        };
+        walk(walk, reduction.node, length, false);
+
+        for (const auto& [bottom, pathChildren] : paths) {
+            int target = table.gotoAt(stackNodes[bottom].state, left);
+            if (target < 0) continue;
+            uint32_t symbol = symbolNode(forest, table.terminalCount + left, stackNodes[bottom].level, position);
+            forest.addFamily(symbol, reduction.production, pathChildren);
+
+            uint32_t top = findNode(target);
+            if (top == SharedPackedForest::NONE) {
+                top = newNode(target, position);
+                addEdge(top, bottom, symbol);
+                frontier.push_back(top);
+                enqueueReductions(top, terminal, SharedPackedForest::NONE, false);
+            } else if (!hasEdge(top, bottom)) {
+                // 已有的栈顶多了一条边：所有栈顶上经过这条边的归约都要重新做
+                uint32_t edge = addEdge(top, bottom, symbol);
+                for (uint32_t node : frontier) enqueueReductions(node, terminal, edge, true);
+            }
+        }
+    }
+}
+
+GLRResult GLRParser::parse(std::span<const int> input, SharedPackedForest& forest) {
+    GLRResult result;
+    forest.clear();
+    forest.reserve(input.size());
+    stackNodes.clear();
+    stackEdges.clear();
+    stackNodes.reserve(input.size() * 2);
+    stackEdges.reserve(input.size() * 2);
+    frontier.assign(1, newNode(0, 0));
+
+    std::vector<uint32_t> next;
+    for (uint32_t position = 0;; position++) {
+        int terminal = input[position];
+        levelSymbols.clear();
+
+        // 确定的部分：一个栈顶、没有冲突时按LR方式归约
+        while (frontier.size() == 1) {
+            int state = stackNodes[frontier[0]].state;
+            if (multi.isConflicted(state, terminal)) break;
+            int32_t action = table.actionAt(state, terminal);
+            if (!LRAction::isReduce(action)) break;
+            if (!reduceDeterministic(frontier[0], LRAction::reduceProduction(action), position, forest)) break;
+        }
+        reduceAll(terminal, position, forest);
+
+        if (terminal == table.endMarker) {
+            // 接受：栈顶经过开始符号回到最底层的结点，这条边上就是整个输入的森林
+            int32_t single;
+            for (uint32_t node : frontier) {
+                for (int32_t action : actionsOf(stackNodes[node].state, terminal, single)) {
+                    if (action != LRAction::ACCEPT) continue;
+                    for (uint32_t edge = stackNodes[node].firstEdge; edge != SharedPackedForest::NONE; edge = stackEdges[edge].next) {
+                        if (stackEdges[edge].target == 0) {
+                            forest.setRoot(stackEdges[edge].forestNode);
+                            result.accepted = true;
+                        }
+                    }
+                }
+            }
+            if (!result.accepted) {
+                result.errorPosition = position;
+                result.errorState = stackNodes[frontier[0]].state;
+            }
+            break;
+        }
+
+        // 移进：所有能移进当前终结符的栈顶一起前进，到达相同状态的合并
+        next.clear();
+        uint32_t leaf = SharedPackedForest::NONE;
+        for (uint32_t node : frontier) {
+            int32_t single;
+            for (int32_t action : actionsOf(stackNodes[node].state, terminal, single)) {
+                if (!LRAction::isShift(action)) continue;
+                if (leaf == SharedPackedForest::NONE) leaf = forest.addNode(terminal, position, position + 1);
+                int target = LRAction::shiftTarget(action);
+                auto found = std::find_if(next.begin(), next.end(), [&](uint32_t candidate) {
+                    return stackNodes[candidate].state == target;
+                });
+                uint32_t top = found != next.end() ? *found : newNode(target, position + 1);
+                if (found == next.end()) next.push_back(top);
+                addEdge(top, node, leaf);
+            }
+        }
+        if (next.empty()) {
+            result.errorPosition = position;
+            result.errorState = stackNodes[frontier[0]].state;
+            break;
+        }
+        frontier.swap(next);
+    }
+    result.stackNodes = stackNodes.size();
+    return result;
+}
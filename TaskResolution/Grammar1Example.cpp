@@ -0,0 +1,46 @@
+#include "Grammar1Parser.h"
+#include "LexicalAnalyzer.h"
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// 使用为grammar_1.txt生成的递归上升分析器分析一个输入文件，输出规约序列
+int main(int argc, char* argv[]) {
+    std::string inputPath = argc > 1 ? argv[1] : "../TestCase/Task2Case/input_1_2.txt";
+    std::ifstream source_file(inputPath);
+    if (!source_file.is_open()) {
+        std::cerr << "Error: Could not open source code file " << inputPath << std::endl;
+        return 1;
+    }
+    std::string source_code((std::istreambuf_iterator<char>(source_file)),
+                            std::istreambuf_iterator<char>());
+
+    std::vector<Token> lexical_tokens = LexicalAnalyzer::analyze(source_code);
+    LexicalAnalyzer::processTokens(lexical_tokens);
+
+    // 生成的分析器只接受终结符编号：先按名称查找，再看文法是否为该Token类型绑定了终结符
+    std::vector<int> terminals;
+    for (const auto& token : lexical_tokens) {
+        int terminal = grammar1::terminalId(token.value);
+        if (terminal < 0) terminal = grammar1::boundTerminal(token.type);
+        if (terminal < 0) {
+            std::cout << "Token '" << token.value << "' (line " << token.line_number
+                      << ") 不在文法的终结符集合中" << std::endl;
+            return 1;
+        }
+        terminals.push_back(terminal);
+    }
+
+    auto printReduction = [](int production, void*) {
+        std::cout << "r" << production << "(" << grammar1::productionText(production) << ")\n";
+    };
+    grammar1::ParseResult result = grammar1::parse(terminals.data(), terminals.size(), printReduction);
+    if (result.accepted) {
+        std::cout << "接受" << std::endl;
+        return 0;
+    }
+    std::cout << "Error: No action defined for state " << result.errorState
+              << " at token " << result.errorPosition << std::endl;
+    return 1;
+}
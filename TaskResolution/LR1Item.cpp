@@ -1,25 +1,23 @@
 #include "LR1Item.h"
 
-std::string LR1Item::toString() const {
-    std::string result = prod.left.name + " -> ";
+std::string LR1Item::toString(const SymbolTable& symbols, const std::vector<Symbol>& terminalSymbols) const {
+    std::string result = symbols.name(prod.left) + " -> ";
 
     // 输出产生式内容
     for (size_t i = 0; i < prod.right.size(); i++) {
         if (i == dotPosition) result += "· ";
-        result += prod.right[i].name + " ";
+        result += symbols.name(prod.right[i]) + " ";
     }
     if (dotPosition == prod.right.size()) result += "· ";
 
-    // 合并输出向前搜索符，去除epsilon
+    // 合并输出向前搜索符
     result += ", { ";
     bool first = true;
-    for (const auto& symbol : lookahead) {
-        if (symbol.type != EPSILON) {
-            if (!first) result += ", ";
-            result += symbol.name;
-            first = false;
-        }
-    }
+    lookahead.forEach([&](int id) {
+        if (!first) result += ", ";
+        result += symbols.name(terminalSymbols[id]);
+        first = false;
+    });
     result += " }";
     return result;
 }
@@ -38,7 +36,7 @@ bool LR1Item::operator<(const LR1Item& other) const {
 
 Symbol LR1Item::getNextSymbol() const {
     if (dotPosition >= prod.right.size()) {
-        return Symbol("#", END_MARKER);
+        return END_SYMBOL;
     }
     return prod.right[dotPosition];
 }
@@ -21,6 +21,7 @@ bool LexicalAnalysis::loadGrammar(const std::string& grammar_file) {
     nfa_states.clear();
     dfa_states.clear();
     grammar_rules.clear();
+    utf8_suffix_states.clear();
 
     std::cout << "=== 开始加载文法规则 ===" << std::endl;
 
@@ -70,9 +71,33 @@ bool LexicalAnalysis::loadGrammar(const std::string& grammar_file) {
     std::cout << "DFA状态总数: " << dfa_states.size() << std::endl;
     std::cout << "起始状态ID: " << dfa_start->id << std::endl;
 
+    // 编译为只读的稠密转移表
+    compiled_lexer = compileDFA();
+
     return true;
 }
 
+CompiledLexer LexicalAnalysis::compileDFA() const {
+    CompiledLexer lexer;
+    lexer.transitions.assign(dfa_states.size() * 256, -1);
+    lexer.accepting.resize(dfa_states.size());
+    lexer.token_types.resize(dfa_states.size());
+
+    // DFA状态的id即其在dfa_states中的下标，起始状态为0
+    for (const auto& state : dfa_states) {
+        lexer.accepting[state->id] = state->is_final;
+        lexer.token_types[state->id] = state->token_type;
+        for (const auto& [c, target] : state->transitions) {
+            lexer.transitions[static_cast<size_t>(state->id) * 256 + c] = target->id;
+        }
+    }
+
+    for (const auto& rule : grammar_rules) {
+        if (rule.type == KEYWORD) lexer.keywords.insert(rule.pattern);
+    }
+    return lexer;
+}
+
 void LexicalAnalysis::buildNFA(const std::string& grammar_file) {
     // 创建NFA的起始状态
     nfa_start = std::make_shared<NFAState>();
@@ -87,6 +112,162 @@ void LexicalAnalysis::buildNFA(const std::string& grammar_file) {
     }
 }
 
+namespace {
+    struct CodepointRange {
+        uint32_t lo;
+        uint32_t hi;
+    };
+
+    // C11 附录D.1：允许出现在标识符中的非ASCII字符范围
+    constexpr CodepointRange identifier_ranges[] = {
+        {0x00A8, 0x00A8}, {0x00AA, 0x00AA}, {0x00AD, 0x00AD}, {0x00AF, 0x00AF},
+        {0x00B2, 0x00B5}, {0x00B7, 0x00BA}, {0x00BC, 0x00BE}, {0x00C0, 0x00D6},
+        {0x00D8, 0x00F6}, {0x00F8, 0x00FF}, {0x0100, 0x167F}, {0x1681, 0x180D},
+        {0x180F, 0x1FFF}, {0x200B, 0x200D}, {0x202A, 0x202E}, {0x203F, 0x2040},
+        {0x2054, 0x2054}, {0x2060, 0x206F}, {0x2070, 0x218F}, {0x2460, 0x24FF},
+        {0x2776, 0x2793}, {0x2C00, 0x2DFF}, {0x2E80, 0x2FFF}, {0x3004, 0x3007},
+        {0x3021, 0x302F}, {0x3031, 0x303F}, {0x3040, 0xD7FF}, {0xF900, 0xFD3D},
+        {0xFD40, 0xFDCF}, {0xFDF0, 0xFE44}, {0xFE47, 0xFFFD}, {0x10000, 0x1FFFD},
+        {0x20000, 0x2FFFD}, {0x30000, 0x3FFFD}, {0x40000, 0x4FFFD}, {0x50000, 0x5FFFD},
+        {0x60000, 0x6FFFD}, {0x70000, 0x7FFFD}, {0x80000, 0x8FFFD}, {0x90000, 0x9FFFD},
+        {0xA0000, 0xAFFFD}, {0xB0000, 0xBFFFD}, {0xC0000, 0xCFFFD}, {0xD0000, 0xDFFFD},
+        {0xE0000, 0xEFFFD},
+    };
+
+    // C11 附录D.2：不能作为标识符首字符的组合附加符号
+    constexpr CodepointRange combining_ranges[] = {
+        {0x0300, 0x036F}, {0x1DC0, 0x1DFF}, {0x20D0, 0x20FF}, {0xFE20, 0xFE2F},
+    };
+
+    int utf8Length(uint32_t cp) {
+        if (cp <= 0x7F) return 1;
+        if (cp <= 0x7FF) return 2;
+        if (cp <= 0xFFFF) return 3;
+        return 4;
+    }
+
+    void encodeUtf8(uint32_t cp, unsigned char* out) {
+        switch (utf8Length(cp)) {
+            case 1:
+                out[0] = static_cast<unsigned char>(cp);
+                break;
+            case 2:
+                out[0] = static_cast<unsigned char>(0xC0 | (cp >> 6));
+                out[1] = static_cast<unsigned char>(0x80 | (cp & 0x3F));
+                break;
+            case 3:
+                out[0] = static_cast<unsigned char>(0xE0 | (cp >> 12));
+                out[1] = static_cast<unsigned char>(0x80 | ((cp >> 6) & 0x3F));
+                out[2] = static_cast<unsigned char>(0x80 | (cp & 0x3F));
+                break;
+            default:
+                out[0] = static_cast<unsigned char>(0xF0 | (cp >> 18));
+                out[1] = static_cast<unsigned char>(0x80 | ((cp >> 12) & 0x3F));
+                out[2] = static_cast<unsigned char>(0x80 | ((cp >> 6) & 0x3F));
+                out[3] = static_cast<unsigned char>(0x80 | (cp & 0x3F));
+                break;
+        }
+    }
+}
+
+void LexicalAnalysis::addCodepointRange(const std::shared_ptr<NFAState>& from,
+                                        const std::vector<std::shared_ptr<NFAState>>& targets,
+                                        uint32_t lo, uint32_t hi) {
+    /*
+     * 把码点区间[lo, hi]编译为若干条UTF-8字节序列路径，而不是在扫描时解码码点：
+     * 1. 去掉代理区D800-DFFF，并在1/2/3/4字节编码长度的分界处切分区间；
+     * 2. 对同一长度的区间继续切分，直到每个区间的每一位字节都恰好覆盖一个连续的字节范围，
+     *    此时区间等价于 [a1-b1][a2-b2]...[an-bn] 这样的字节类序列；
+     * 3. 为每个字节类序列创建一条从from出发的状态链，最后一个字节转移到targets。
+     */
+    if (lo > hi) return;
+
+    if (lo <= 0xDFFF && hi >= 0xD800) {
+        if (lo < 0xD800) addCodepointRange(from, targets, lo, 0xD7FF);
+        if (hi > 0xDFFF) addCodepointRange(from, targets, 0xE000, hi);
+        return;
+    }
+
+    for (uint32_t max : {0x7Fu, 0x7FFu, 0xFFFFu}) {
+        if (lo <= max && hi > max) {
+            addCodepointRange(from, targets, lo, max);
+            addCodepointRange(from, targets, max + 1, hi);
+            return;
+        }
+    }
+
+    int length = utf8Length(lo);
+    for (int i = 1; i < length; i++) {
+        uint32_t mask = (1u << (6 * i)) - 1;
+        if ((lo & ~mask) != (hi & ~mask)) {
+            if ((lo & mask) != 0) {
+                addCodepointRange(from, targets, lo, lo | mask);
+                addCodepointRange(from, targets, (lo | mask) + 1, hi);
+                return;
+            }
+            if ((hi & mask) != mask) {
+                addCodepointRange(from, targets, lo, (hi & ~mask) - 1);
+                addCodepointRange(from, targets, hi & ~mask, hi);
+                return;
+            }
+        }
+    }
+
+    unsigned char first[4], last[4];
+    encodeUtf8(lo, first);
+    encodeUtf8(hi, last);
+
+    // 从后往前构造状态链；相同的“剩余字节类序列+目标状态”共用同一个NFA状态，
+    // 避免每个区间都复制一份后续字节的状态，子集构造得到的DFA也更小
+    std::vector<std::shared_ptr<NFAState>> next_states = targets;
+    for (int k = length - 1; k >= 1; k--) {
+        Utf8SuffixKey key;
+        key.ranges.assign({{first[k], last[k]}});
+        for (const auto& target : next_states) key.targets.push_back(target.get());
+        auto& state = utf8_suffix_states[key];
+        if (!state) {
+            state = std::make_shared<NFAState>();
+            state->id = nfa_states.size();
+            nfa_states.push_back(state);
+            for (unsigned c = first[k]; c <= last[k]; c++) {
+                auto& moves = state->transitions[static_cast<unsigned char>(c)];
+                moves.insert(moves.end(), next_states.begin(), next_states.end());
+            }
+        }
+        next_states = {state};
+    }
+    for (unsigned c = first[0]; c <= last[0]; c++) {
+        auto& moves = from->transitions[static_cast<unsigned char>(c)];
+        moves.insert(moves.end(), next_states.begin(), next_states.end());
+    }
+}
+
+void LexicalAnalysis::addIdentifierClass(const std::shared_ptr<NFAState>& from,
+                                         const std::vector<std::shared_ptr<NFAState>>& targets,
+                                         bool continuation) {
+    addCodepointRange(from, targets, 'a', 'z');
+    addCodepointRange(from, targets, 'A', 'Z');
+    addCodepointRange(from, targets, '_', '_');
+    if (continuation) {
+        addCodepointRange(from, targets, '0', '9');
+    }
+
+    for (const auto& range : identifier_ranges) {
+        if (continuation) {
+            addCodepointRange(from, targets, range.lo, range.hi);
+            continue;
+        }
+        // 首字符需要扣除组合附加符号
+        uint32_t lo = range.lo;
+        for (const auto& excluded : combining_ranges) {
+            if (excluded.hi < lo || excluded.lo > range.hi) continue;
+            if (excluded.lo > lo) addCodepointRange(from, targets, lo, excluded.lo - 1);
+            lo = excluded.hi + 1;
+        }
+        if (lo <= range.hi) addCodepointRange(from, targets, lo, range.hi);
+    }
+}
+
 std::shared_ptr<NFAState> LexicalAnalysis::createNFAForPattern(
     //为单个正则表达式模式创建一个NFA片段，并指定其接受状态对应的 TokenType。
     const std::string& pattern, TokenType type) {
@@ -118,7 +299,7 @@ std::shared_ptr<NFAState> LexicalAnalysis::createNFAForPattern(
                 next->id = nfa_states.size();
                 nfa_states.push_back(next);
             }
-            current->transitions[pattern[i]].push_back(next);
+            current->transitions[static_cast<unsigned char>(pattern[i])].push_back(next);
             current = next;
         }
     }
@@ -127,7 +308,8 @@ std::shared_ptr<NFAState> LexicalAnalysis::createNFAForPattern(
         // 特殊处理标识符规则 [a-zA-Z_][a-zA-Z0-9_]*
         if (type == IDENTIFIER) {
             /*
-            * 标识符 (IDENTIFIER): 硬编码实现了一个NFA来匹配 [a-zA-Z_][a-zA-Z0-9_]* 这样的模式。
+            * 标识符 (IDENTIFIER): 硬编码实现了一个NFA来匹配 [a-zA-Z_][a-zA-Z0-9_]* 这样的模式，
+            并按C11附录D允许的Unicode字符范围扩展，非ASCII字符被编译为UTF-8字节序列，DFA仍然逐字节运行。
             创建一个中间状态 middle。
             从 start 状态到 middle 状态添加对所有首字符（a-z, A-Z, _）的转换。
             从 middle 状态到其自身添加对所有后续字符（a-z, A-Z, 0-9, _）的转换（表示 * 闭包）。
@@ -136,28 +318,11 @@ std::shared_ptr<NFAState> LexicalAnalysis::createNFAForPattern(
             auto middle = std::make_shared<NFAState>();
             middle->id = nfa_states.size();
             nfa_states.push_back(middle);
-            // 首字符: a-z, A-Z, _
-            for (char c = 'a'; c <= 'z'; c++)
-                start->transitions[c].push_back(middle);
-            for (char c = 'A'; c <= 'Z'; c++)
-                start->transitions[c].push_back(middle);
-            start->transitions['_'].push_back(middle);
-
-            // 后续字符: a-z, A-Z, 0-9, _
-            for (char c = 'a'; c <= 'z'; c++) {
-                middle->transitions[c].push_back(middle);
-                middle->transitions[c].push_back(end);
-            }
-            for (char c = 'A'; c <= 'Z'; c++) {
-                middle->transitions[c].push_back(middle);
-                middle->transitions[c].push_back(end);
-            }
-            for (char c = '0'; c <= '9'; c++) {
-                middle->transitions[c].push_back(middle);
-                middle->transitions[c].push_back(end);
-            }
-            middle->transitions['_'].push_back(middle);
-            middle->transitions['_'].push_back(end);
+            // 首字符: a-z, A-Z, _ 以及Unicode标识符字符（按UTF-8字节序列展开）
+            addIdentifierClass(start, {middle}, false);
+
+            // 后续字符: a-z, A-Z, 0-9, _ 以及Unicode标识符字符（包括组合附加符号）
+            addIdentifierClass(middle, {middle, end}, true);
             middle->epsilon_transitions.push_back(end);
         }
         // 处理常量规则
@@ -259,7 +424,7 @@ void LexicalAnalysis::convertNFAtoDFA() {
         }
 
         // 获取所有可能的输入字符
-        std::set<char> inputs;
+        std::set<unsigned char> inputs;
         for (const auto& state : current_states) {
             for (const auto& trans : state->transitions) {
                 inputs.insert(trans.first);
@@ -267,7 +432,7 @@ void LexicalAnalysis::convertNFAtoDFA() {
         }
 
         // 对每个输入字符创建转换
-        for (char input : inputs) {
+        for (unsigned char input : inputs) {
             auto moved_states = move(current_states, input);
             if (moved_states.empty()) continue;
 
@@ -299,194 +464,8 @@ void LexicalAnalysis::convertNFAtoDFA() {
     }
 }
 
-std::vector<Token> LexicalAnalysis::analyze(const std::string& source_code) {
-    std::vector<Token> tokens;
-    int line_number = 1;
-    size_t i = 0;
-
-    while (i < source_code.length()) {
-        char c = source_code[i];
-        // 跳过空白字符
-        if (isspace(c)) {
-            if (c == '\n') line_number++;
-            i++;
-            continue;
-        }
-
-        // 检查是否是数字（可能是常量的开始）
-        if (isdigit(c)) {
-            std::string number;
-            size_t j = i;
-        // 读取整数部分
-        while (j < source_code.length() && isdigit(source_code[j])) {
-            number += source_code[j++];
-        }
-
-        // 检查是否为非法标识符
-        if (j < source_code.length() && isalpha(source_code[j])) {
-            std::string invalid_token = number;
-            while (j < source_code.length() && (isalnum(source_code[j]) || source_code[j] == '_')) {
-                invalid_token += source_code[j++];
-            }
-            tokens.push_back({INVALID, invalid_token, line_number});
-            std::cerr << "Error at line " << line_number
-                 << ": Identifier cannot start with a number: "
-                 << invalid_token << std::endl;
-            i = j;
-            continue;
-        }
-
-        // 检查小数点
-        if (j < source_code.length() && source_code[j] == '.') {
-            number += source_code[j++];
-            while (j < source_code.length() && isdigit(source_code[j])) {
-                number += source_code[j++];
-            }
-        }
-
-        // 检查科学计数法
-        if (j < source_code.length() && (source_code[j] == 'e' || source_code[j] == 'E')) {
-            number += source_code[j++];
-            if (j < source_code.length() && (source_code[j] == '+' || source_code[j] == '-')) {
-                number += source_code[j++];
-            }
-            while (j < source_code.length() && isdigit(source_code[j])) {
-                number += source_code[j++];
-            }
-        }
-
-        // 检查复数
-        else if (j < source_code.length() && (source_code[j] == '+' || source_code[j] == '-')) {
-            number += source_code[j++];
-            while (j < source_code.length() && isdigit(source_code[j])) {
-                number += source_code[j++];
-            }
-            if (j < source_code.length() && source_code[j] == '.') {
-                number += source_code[j++];
-                while (j < source_code.length() && isdigit(source_code[j])) {
-                    number += source_code[j++];
-                }
-            }
-            if (j < source_code.length() && source_code[j] == 'i') {
-                number += source_code[j++];
-            }
-        }
-
-        tokens.push_back({CONSTANT, number, line_number});
-        i = j;
-        continue;
-        }
-
-        // 首先检查是否是限定符或运算符
-        std::string special_chars = "[](){};,+-*/<>=!";
-        if (special_chars.find(c) != std::string::npos) {
-            std::string op;
-            op += c;
-
-            // 检查双字符运算符
-            if (i + 1 < source_code.length()) {
-                char next = source_code[i + 1];
-                std::string double_op = op + next;
-                if ((c == '=' && next == '=') ||
-                    (c == '!' && next == '=') ||
-                    (c == '<' && next == '=') ||
-                    (c == '>' && next == '=')) {
-                    op = double_op;
-                    i++;
-                }
-            }
-
-            // 确定token类型
-            TokenType type;
-            if (std::string("[](){};,").find(c) != std::string::npos) {
-                type = LIMITER;
-            } else {
-                type = OPERATOR;
-            }
-
-            tokens.push_back({type, op, line_number});
-            i++;
-            continue;
-        }
-
-        // 尝试匹配最长的token
-        std::string longest_match;
-        TokenType best_type = INVALID;
-        size_t best_length = 0;
-        size_t best_pos = i;
-
-        // 提取可能的token
-        std::string possible_token;
-        size_t j = i;
-        while (j < source_code.length() &&
-               !isspace(source_code[j]) &&
-               special_chars.find(source_code[j]) == std::string::npos) {
-            possible_token += source_code[j];
-            j++;
-        }
-
-        // 首先检查是否是关键字
-        for (const auto& rule : grammar_rules) {
-            if (rule.type == KEYWORD && possible_token == rule.pattern) {
-                longest_match = possible_token;
-                best_type = KEYWORD;
-                best_length = possible_token.length();
-                best_pos = i + best_length - 1;
-                break;
-            }
-        }
-
-        // 如果不是关键字，再尝试其他模式
-        if (best_type == INVALID) {
-            auto current_state = dfa_start;
-            std::string current_token;
-
-            // 检查第一个字符是否是数字
-            bool starts_with_digit = isdigit(source_code[i]);
-
-            for (size_t k = i; k < source_code.length(); k++) {
-                char curr_char = source_code[k];
-                if (isspace(curr_char) || special_chars.find(curr_char) != std::string::npos) break;
-
-                auto it = current_state->transitions.find(curr_char);
-                if (it == current_state->transitions.end()) break;
-
-                current_state = it->second;
-                current_token += curr_char;
-
-                if (current_state->is_final) {
-                    // 如果是标识符且以数字开头，跳过这种情况，后面再进行处理
-                    if (current_state->token_type == IDENTIFIER && starts_with_digit) {
-                        continue;
-                    }
-                    longest_match = current_token;
-                    best_type = current_state->token_type;
-                    best_length = current_token.length();
-                    best_pos = k;
-                }
-            }
-        }
-
-        if (best_type != INVALID) {
-            tokens.push_back({best_type, longest_match, line_number});
-            i = best_pos + 1;
-        } else if (!possible_token.empty()) {
-            // 如果是以数字开头的标识符，作为一个整体处理为Invalid类型
-            if (isdigit(possible_token[0]) && std::any_of(possible_token.begin() + 1, possible_token.end(), ::isalpha)) {
-                tokens.push_back({INVALID, possible_token, line_number});
-                std::cerr << "Error at line " << line_number
-                         << ": Identifier cannot start with a number: "
-                         << possible_token << std::endl;
-                i = i + possible_token.length();
-            } else {
-                std::cerr << "Error: Unrecognized token at line " << line_number
-                         << ": " << possible_token << std::endl;
-                i++;
-            }
-        }
-    }
-
-    return tokens;
+std::vector<Token> LexicalAnalysis::analyze(const std::string& source_code) const {
+    return LexicalScanner(compiled_lexer, source_code).scanAll();
 }
 
 std::string LexicalAnalysis::readSourceFile(const std::string& filename) {
@@ -500,8 +479,12 @@ std::string LexicalAnalysis::readSourceFile(const std::string& filename) {
     );
 }
 
-void LexicalAnalysis::printTokens(const std::vector<Token>& tokens) {
-    std::cout<< "\n=== 词法分析结果 ===" << std::endl;
+void LexicalAnalysis::printTokens(const std::vector<Token>& tokens, const LineIndex& lines) {
+    printTokens(tokens, lines, std::cout);
+}
+
+void LexicalAnalysis::printTokens(const std::vector<Token>& tokens, const LineIndex& lines, std::ostream& out) {
+    out << "\n=== 词法分析结果 ===" << '\n';
     for (size_t i = 0; i < tokens.size(); i++) {
         const auto& token = tokens[i];
 
@@ -509,21 +492,26 @@ void LexicalAnalysis::printTokens(const std::vector<Token>& tokens) {
         if (i > 0 && tokens[i-1].type == KEYWORD &&
             token.type == CONSTANT && i+1 < tokens.size() &&
             tokens[i+1].type == IDENTIFIER) {
-            std::cerr << "Error at line " << token.line_number
+            std::cerr << "Error at line " << lines.line(token.offset)
+                     << ", column " << lines.column(token.offset)
                      << ": Identifier cannot start with a number" << std::endl;
             }
-        std::cout << "(Line: " << token.line_number << ", Type: ";
-        switch (token.type) {
-            case KEYWORD: std::cout << "Keyword"; break;
-            case IDENTIFIER: std::cout << "Identifier"; break;
-            case CONSTANT: std::cout << "Constant"; break;
-            case LIMITER: std::cout << "Limiter"; break;
-            case OPERATOR: std::cout << "Operator"; break;
-            default: std::cout << "Invalid"; break;
-        }
-        std::cout << ", Value: " << token.value << ")" << std::endl;
+        out << "(Line: " << lines.line(token.offset) << ", Type: " << tokenTypeName(token.type)
+            << ", Value: " << token.value << ")" << '\n';
+    }
+}
+
+const char* LexicalAnalysis::tokenTypeName(TokenType type) {
+    switch (type) {
+        case KEYWORD: return "Keyword";
+        case IDENTIFIER: return "Identifier";
+        case CONSTANT: return "Constant";
+        case LIMITER: return "Limiter";
+        case OPERATOR: return "Operator";
+        default: return "Invalid";
     }
 }
+
 std::set<std::shared_ptr<NFAState>> LexicalAnalysis::getEpsilonClosure(
     const std::set<std::shared_ptr<NFAState>>& states) {
     std::set<std::shared_ptr<NFAState>> closure = states;
@@ -558,7 +546,7 @@ std::set<std::shared_ptr<NFAState>> LexicalAnalysis::getEpsilonClosure(
 }
 
 std::set<std::shared_ptr<NFAState>> LexicalAnalysis::move(
-    const std::set<std::shared_ptr<NFAState>>& states, char c) {
+    const std::set<std::shared_ptr<NFAState>>& states, unsigned char c) {
     std::set<std::shared_ptr<NFAState>> result;
     // 对每个状态检查字符c的转换
     for (const auto& state : states) {
@@ -0,0 +1,211 @@
+#include "LexicalAnalysis.h"
+#include <algorithm>
+#include <iostream>
+#include <string_view>
+
+namespace {
+    // 限定符和运算符的首字符
+    constexpr std::string_view special_chars = "[](){};,+-*/<>=!";
+    constexpr std::string_view limiter_chars = "[](){};,";
+
+    bool isSpecial(char c) {
+        return special_chars.find(c) != std::string_view::npos;
+    }
+
+    // <cctype>函数的参数必须能表示为unsigned char，UTF-8的多字节序列在char上是负数
+    int byte(char c) {
+        return static_cast<unsigned char>(c);
+    }
+}
+
+LexicalScanner::LexicalScanner(const CompiledLexer& lexer, const std::string& source_code)
+    : lexer(lexer), source_code(source_code), i(0) {}
+
+std::string LexicalScanner::location(size_t offset) {
+    // 行号索引只在需要报错时才构建，正常扫描路径上不做逐字符的行号统计
+    if (!lines) lines = std::make_unique<LineIndex>(source_code);
+    return "line " + std::to_string(lines->line(offset)) +
+           ", column " + std::to_string(lines->column(offset));
+}
+
+std::vector<Token> LexicalScanner::scanAll() {
+    std::vector<Token> tokens;
+    Token token;
+    while (next(token)) {
+        tokens.push_back(std::move(token));
+    }
+    return tokens;
+}
+
+bool LexicalScanner::next(Token& token) {
+    while (i < source_code.length()) {
+        char c = source_code[i];
+        // 跳过空白字符
+        if (isspace(byte(c))) {
+            i++;
+            continue;
+        }
+
+        // 检查是否是数字（可能是常量的开始）
+        if (isdigit(byte(c))) {
+            std::string number;
+            size_t j = i;
+        // 读取整数部分
+        while (j < source_code.length() && isdigit(byte(source_code[j]))) {
+            number += source_code[j++];
+        }
+
+        // 检查是否为非法标识符
+        if (j < source_code.length() && isalpha(byte(source_code[j]))) {
+            std::string invalid_token = number;
+            while (j < source_code.length() && (isalnum(byte(source_code[j])) || source_code[j] == '_')) {
+                invalid_token += source_code[j++];
+            }
+            token = {INVALID, invalid_token, i};
+            std::cerr << "Error at " << location(i)
+                 << ": Identifier cannot start with a number: "
+                 << invalid_token << std::endl;
+            i = j;
+            return true;
+        }
+
+        // 检查小数点
+        if (j < source_code.length() && source_code[j] == '.') {
+            number += source_code[j++];
+            while (j < source_code.length() && isdigit(byte(source_code[j]))) {
+                number += source_code[j++];
+            }
+        }
+
+        // 检查科学计数法
+        if (j < source_code.length() && (source_code[j] == 'e' || source_code[j] == 'E')) {
+            number += source_code[j++];
+            if (j < source_code.length() && (source_code[j] == '+' || source_code[j] == '-')) {
+                number += source_code[j++];
+            }
+            while (j < source_code.length() && isdigit(byte(source_code[j]))) {
+                number += source_code[j++];
+            }
+        }
+
+        // 检查复数
+        else if (j < source_code.length() && (source_code[j] == '+' || source_code[j] == '-')) {
+            number += source_code[j++];
+            while (j < source_code.length() && isdigit(byte(source_code[j]))) {
+                number += source_code[j++];
+            }
+            if (j < source_code.length() && source_code[j] == '.') {
+                number += source_code[j++];
+                while (j < source_code.length() && isdigit(byte(source_code[j]))) {
+                    number += source_code[j++];
+                }
+            }
+            if (j < source_code.length() && source_code[j] == 'i') {
+                number += source_code[j++];
+            }
+        }
+
+        token = {CONSTANT, number, i};
+        i = j;
+        return true;
+        }
+
+        // 首先检查是否是限定符或运算符
+        if (isSpecial(c)) {
+            size_t start = i;
+            std::string op;
+            op += c;
+
+            // 检查双字符运算符
+            if (i + 1 < source_code.length()) {
+                char next = source_code[i + 1];
+                if ((c == '=' && next == '=') ||
+                    (c == '!' && next == '=') ||
+                    (c == '<' && next == '=') ||
+                    (c == '>' && next == '=')) {
+                    op += next;
+                    i++;
+                }
+            }
+
+            // 确定token类型
+            TokenType type;
+            if (limiter_chars.find(c) != std::string_view::npos) {
+                type = LIMITER;
+            } else {
+                type = OPERATOR;
+            }
+
+            token = {type, op, start};
+            i++;
+            return true;
+        }
+
+        // 尝试匹配最长的token
+        size_t best_length = 0;
+        TokenType best_type = INVALID;
+
+        // 提取可能的token
+        size_t j = i;
+        while (j < source_code.length() &&
+               !isspace(byte(source_code[j])) &&
+               !isSpecial(source_code[j])) {
+            j++;
+        }
+        std::string_view possible_token(source_code.data() + i, j - i);
+
+        // 首先检查是否是关键字
+        if (lexer.isKeyword(possible_token)) {
+            best_type = KEYWORD;
+            best_length = possible_token.length();
+        }
+
+        // 如果不是关键字，再在稠密转移表上运行DFA
+        if (best_type == INVALID) {
+            int current_state = lexer.startState();
+
+            // 检查第一个字符是否是数字
+            bool starts_with_digit = isdigit(byte(source_code[i]));
+
+            for (size_t k = i; k < j; k++) {
+                current_state = lexer.next(current_state, static_cast<unsigned char>(source_code[k]));
+                if (current_state < 0) break;
+
+                if (lexer.isFinal(current_state)) {
+                    // 如果是标识符且以数字开头，跳过这种情况，后面再进行处理
+                    if (lexer.tokenType(current_state) == IDENTIFIER && starts_with_digit) {
+                        continue;
+                    }
+                    best_type = lexer.tokenType(current_state);
+                    best_length = k - i + 1;
+                }
+            }
+        }
+
+        if (best_type != INVALID) {
+            token = {best_type, std::string(source_code, i, best_length), i};
+            i += best_length;
+            return true;
+        } else if (!possible_token.empty()) {
+            // 如果是以数字开头的标识符，作为一个整体处理为Invalid类型
+            if (isdigit(byte(possible_token[0])) && std::any_of(possible_token.begin() + 1, possible_token.end(),
+                                                                 [](char ch) { return isalpha(byte(ch)) != 0; })) {
+                token = {INVALID, std::string(possible_token), i};
+                std::cerr << "Error at " << location(i)
+                         << ": Identifier cannot start with a number: "
+                         << possible_token << std::endl;
+                i = i + possible_token.length();
+                return true;
+            } else {
+                std::cerr << "Error: Unrecognized token at " << location(i)
+                         << ": " << possible_token << std::endl;
+                // 跳过一个完整的字符，不停在UTF-8多字节序列的中间
+                do {
+                    i++;
+                } while (i < source_code.length() && (byte(source_code[i]) & 0xC0) == 0x80);
+            }
+        }
+    }
+
+    return false;
+}
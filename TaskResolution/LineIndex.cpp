@@ -0,0 +1,33 @@
+#include "LineIndex.h"
+#include <algorithm>
+#include <cstring>
+
+LineIndex::LineIndex(const std::string& source) {
+    line_starts.push_back(0);
+    // memchr由标准库按字长/SIMD实现，比逐字符比较'\n'快得多
+    const char* begin = source.data();
+    const char* end = begin + source.size();
+    const char* p = begin;
+    while (p < end) {
+        const void* hit = std::memchr(p, '\n', end - p);
+        if (hit == nullptr) break;
+        p = static_cast<const char*>(hit) + 1;
+        line_starts.push_back(p - begin);
+    }
+}
+
+size_t LineIndex::lineOf(size_t offset) const {
+    // 找到最后一个不大于offset的行首位置
+    auto it = std::upper_bound(line_starts.begin(), line_starts.end(), offset);
+    return (it - line_starts.begin()) - 1;
+}
+
+int LineIndex::line(size_t offset) const {
+    if (line_starts.empty()) return 1;
+    return static_cast<int>(lineOf(offset)) + 1;
+}
+
+int LineIndex::column(size_t offset) const {
+    if (line_starts.empty()) return static_cast<int>(offset) + 1;
+    return static_cast<int>(offset - line_starts[lineOf(offset)]) + 1;
+}
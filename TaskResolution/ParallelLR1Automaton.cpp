@@ -0,0 +1,122 @@
+#include "SyntaxAnalyzer.h"
+#include "ThreadPool.h"
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+namespace {
+    // 一个状态在并行构造中的结果，编号是发现时分配的临时编号
+    struct StateRecord {
+        std::set<LR1Item> kernel;
+        std::vector<LR1Item> reductions;                 // 闭包中的完成项目
+        std::vector<std::pair<Symbol, int>> successors;  // (符号, 后继的临时编号)，按符号首次出现的顺序
+    };
+
+    // 分片的 核心 -> 临时编号 表：按核心的哈希值选择分片，不同分片上的查找和插入互不阻塞
+    class ShardedKernelMap {
+    public:
+        explicit ShardedKernelMap(size_t shardCount) : shards(shardCount) {}
+
+        // 返回核心对应的编号，核心第一次出现时分配新编号并将inserted置为true
+        int findOrInsert(StateKernel kernel, std::atomic<int>& nextId, bool& inserted) {
+            Shard& shard = shards[StateKernelHash()(kernel) % shards.size()];
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            auto [it, added] = shard.ids.try_emplace(std::move(kernel), 0);
+            if (added) it->second = nextId++;
+            inserted = added;
+            return it->second;
+        }
+
+    private:
+        struct Shard {
+            std::mutex mutex;
+            std::unordered_map<StateKernel, int, StateKernelHash> ids;
+        };
+        std::vector<Shard> shards;
+    };
+}
+
+void SyntaxAnalyzer::buildLR1AutomatonParallel() {
+    /*
+     * 并行构造规范LR(1)自动机：每个状态的闭包和后继核心由线程池中的一个任务计算，
+     * 新发现的核心在分片表中登记后立即作为新任务提交，由工作窃取队列分配给空闲线程。
+     * 临时编号取决于线程的执行顺序，全部完成后按顺序构造的广度优先顺序重新编号，
+     * 再按新编号依次填表，得到的状态编号、分析表和冲突记录都与顺序构造完全相同。
+     */
+    states.clear();
+    actionTable.clear();
+    gotoTable.clear();
+
+    ThreadPool pool(buildThreads);
+    ShardedKernelMap kernelIds(static_cast<size_t>(pool.size()) * 4);
+    std::atomic<int> nextId{0};
+    std::mutex recordsMutex;
+    std::unordered_map<int, std::unique_ptr<StateRecord>> records;
+
+    auto start = std::make_unique<StateRecord>();
+    TerminalSet initialLookahead;
+    initialLookahead.insert(terminalIds.at(END_SYMBOL));
+    start->kernel.insert(LR1Item(productions[0], 0, initialLookahead));
+    bool inserted;
+    kernelIds.findOrInsert(kernelOf(start->kernel), nextId, inserted);
+    records[0] = std::move(start);
+
+    std::function<void(int)> process = [&](int id) {
+        StateRecord* record;
+        {
+            std::lock_guard<std::mutex> lock(recordsMutex);
+            record = records.at(id).get();
+        }
+
+        // closure和goToKernels只读取文法数据，可以在多个线程中同时调用
+        auto items = closure(record->kernel);
+        for (const auto& item : items) {
+            if (item.isComplete()) record->reductions.push_back(item);
+        }
+
+        for (auto& [symbol, kernel] : goToKernels(items)) {
+            bool isNew;
+            int target = kernelIds.findOrInsert(kernelOf(kernel), nextId, isNew);
+            if (isNew) {
+                auto successor = std::make_unique<StateRecord>();
+                successor->kernel = std::move(kernel);
+                {
+                    std::lock_guard<std::mutex> lock(recordsMutex);
+                    records[target] = std::move(successor);
+                }
+                pool.submit([&process, target] { process(target); });
+            }
+            record->successors.emplace_back(symbol, target);
+        }
+    };
+
+    pool.submit([&process] { process(0); });
+    pool.wait();
+
+    // 按顺序构造的发现顺序重新编号：先进先出地处理状态，后继按符号首次出现的顺序编号
+    std::vector<int> order = {0};
+    std::vector<int> newId(records.size(), -1);
+    newId[0] = 0;
+    for (size_t k = 0; k < order.size(); k++) {
+        for (const auto& [symbol, target] : records.at(order[k])->successors) {
+            if (newId[target] == -1) {
+                newId[target] = static_cast<int>(order.size());
+                order.push_back(target);
+            }
+        }
+    }
+
+    // 按新编号填表，规约与移进/转移的填写顺序也与顺序构造一致
+    for (size_t k = 0; k < order.size(); k++) {
+        StateRecord& record = *records.at(order[k]);
+        int state = static_cast<int>(k);
+        for (const auto& item : record.reductions) {
+            emitReduction(state, item);
+        }
+        for (const auto& [symbol, target] : record.successors) {
+            emitTransition(state, symbol, newId[target]);
+        }
+        states[state] = std::move(record.kernel);
+    }
+}
@@ -0,0 +1,273 @@
+#include "ParseTableFile.h"
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+    uint64_t alignUp(uint64_t offset) { return (offset + 7) & ~uint64_t(7); }
+
+    // 按文件布局依次排列各段，返回文件总长度
+    uint64_t layoutSections(ParseTableFileHeader& header) {
+        uint64_t offset = sizeof(ParseTableFileHeader);
+        auto place = [&offset](uint64_t& sectionOffset, uint64_t bytes) {
+            sectionOffset = alignUp(offset);
+            offset = sectionOffset + bytes;
+        };
+        uint64_t states = static_cast<uint64_t>(header.stateCount);
+        uint64_t productions = static_cast<uint64_t>(header.productionCount);
+        uint64_t symbolCount = static_cast<uint64_t>(header.terminalCount) + static_cast<uint64_t>(header.nonTerminalCount);
+        place(header.actionOffset, states * static_cast<uint64_t>(header.terminalCount) * sizeof(int32_t));
+        place(header.gotoOffset, states * static_cast<uint64_t>(header.nonTerminalCount) * sizeof(int32_t));
+        place(header.productionLeftOffset, productions * sizeof(int32_t));
+        place(header.productionLengthOffset, productions * sizeof(int32_t));
+        place(header.productionRightOffsetsOffset, (productions + 1) * sizeof(uint32_t));
+        place(header.productionRightOffset, static_cast<uint64_t>(header.productionRightCount) * sizeof(int32_t));
+        place(header.nameOffsetsOffset, (symbolCount + 1) * sizeof(uint32_t));
+        place(header.nameDataOffset, header.nameDataSize);
+        place(header.tokenBindingsOffset, static_cast<uint64_t>(header.tokenBindingCount) * sizeof(int32_t));
+        return offset;
+    }
+
+    // 写完整个临时文件后再替换，其他进程不会映射到写了一半的文件；
+    // 临时文件名带进程号和序号，几个进程或线程同时写同一个分析表文件时各写各的临时文件
+    bool replaceFile(const std::string& path, const char* bytes, size_t size) {
+        static std::atomic<unsigned> temporaryCounter{0};
+#ifdef _WIN32
+        unsigned long processId = GetCurrentProcessId();
+#else
+        long processId = static_cast<long>(getpid());
+#endif
+        std::string temporaryPath = path + ".tmp." + std::to_string(processId) + "." + std::to_string(temporaryCounter++);
+        {
+            std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+            if (!file.is_open()) {
+                std::cerr << "Error: Cannot write parse table file " << temporaryPath << std::endl;
+                return false;
+            }
+            file.write(bytes, static_cast<std::streamsize>(size));
+            if (!file) {
+                std::cerr << "Error: Failed to write parse table file " << temporaryPath << std::endl;
+                file.close();
+                std::remove(temporaryPath.c_str());
+                return false;
+            }
+        }
+#ifdef _WIN32
+        if (!MoveFileExA(temporaryPath.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING)) {
+#else
+        if (std::rename(temporaryPath.c_str(), path.c_str()) != 0) {
+#endif
+            std::cerr << "Error: Cannot replace parse table file " << path << std::endl;
+            std::remove(temporaryPath.c_str());
+            return false;
+        }
+        return true;
+    }
+}
+
+uint64_t ParseTableFile::grammarHash(const std::string& grammarText, int constructionMode) {
+    uint64_t hash = 14695981039346656037ULL;
+    auto feed = [&hash](unsigned char byte) {
+        hash ^= byte;
+        hash *= 1099511628211ULL;
+    };
+    for (char c : grammarText) feed(static_cast<unsigned char>(c));
+    // 同一文法的不同构造方式得到不同的分析表
+    feed(static_cast<unsigned char>(constructionMode));
+    return hash;
+}
+
+bool ParseTableFile::write(const std::string& path, const ParseTable& table, uint64_t grammarHash) {
+    ParseTableFileHeader header{};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.headerSize = sizeof(ParseTableFileHeader);
+    header.grammarHash = grammarHash;
+    header.stateCount = table.stateCount;
+    header.terminalCount = table.terminalCount;
+    header.nonTerminalCount = table.nonTerminalCount;
+    header.productionCount = static_cast<int32_t>(table.productionLeft.size());
+    header.endMarker = table.endMarker;
+    header.productionRightCount = static_cast<uint32_t>(table.productionRight.size());
+    header.nameDataSize = static_cast<uint32_t>(table.nameData.size());
+    header.tokenBindingCount = static_cast<uint32_t>(table.tokenBindings.size());
+    header.fileSize = layoutSections(header);
+
+    std::vector<char> image(header.fileSize, 0);
+    auto copy = [&image](uint64_t offset, const void* source, size_t bytes) {
+        if (bytes > 0) std::memcpy(image.data() + offset, source, bytes);
+    };
+    copy(0, &header, sizeof(header));
+    copy(header.actionOffset, table.action.data(), table.action.size() * sizeof(int32_t));
+    copy(header.gotoOffset, table.goTo.data(), table.goTo.size() * sizeof(int32_t));
+    copy(header.productionLeftOffset, table.productionLeft.data(), table.productionLeft.size() * sizeof(int32_t));
+    copy(header.productionLengthOffset, table.productionLength.data(), table.productionLength.size() * sizeof(int32_t));
+    copy(header.productionRightOffsetsOffset, table.productionRightOffsets.data(),
+         table.productionRightOffsets.size() * sizeof(uint32_t));
+    copy(header.productionRightOffset, table.productionRight.data(), table.productionRight.size() * sizeof(int32_t));
+    copy(header.nameOffsetsOffset, table.nameOffsets.data(), table.nameOffsets.size() * sizeof(uint32_t));
+    copy(header.nameDataOffset, table.nameData.data(), table.nameData.size());
+    copy(header.tokenBindingsOffset, table.tokenBindings.data(), table.tokenBindings.size() * sizeof(int32_t));
+
+    return replaceFile(path, image.data(), image.size());
+}
+
+MappedParseTable::~MappedParseTable() {
+    close();
+}
+
+bool MappedParseTable::open(const std::string& path, uint64_t expectedHash) {
+    close();
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return false;
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart < static_cast<LONGLONG>(sizeof(ParseTableFileHeader))) {
+        CloseHandle(file);
+        return false;
+    }
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping == nullptr) {
+        CloseHandle(file);
+        return false;
+    }
+    void* address = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (address == nullptr) {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+    fileHandle = file;
+    mappingHandle = mapping;
+    size = static_cast<size_t>(fileSize.QuadPart);
+#else
+    int descriptor = ::open(path.c_str(), O_RDONLY);
+    if (descriptor < 0) return false;
+    struct stat status {};
+    if (fstat(descriptor, &status) != 0 || status.st_size < static_cast<off_t>(sizeof(ParseTableFileHeader))) {
+        ::close(descriptor);
+        return false;
+    }
+    void* address = mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ, MAP_SHARED, descriptor, 0);
+    // 映射建立后文件描述符就不再需要了
+    ::close(descriptor);
+    if (address == MAP_FAILED) return false;
+    size = static_cast<size_t>(status.st_size);
+#endif
+    data = static_cast<const unsigned char*>(address);
+    mappedPath = path;
+
+    if (!validate(expectedHash)) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void MappedParseTable::close() {
+    if (data != nullptr) {
+#ifdef _WIN32
+        UnmapViewOfFile(data);
+        CloseHandle(mappingHandle);
+        CloseHandle(fileHandle);
+        mappingHandle = nullptr;
+        fileHandle = nullptr;
+#else
+        munmap(const_cast<unsigned char*>(data), size);
+#endif
+    }
+    data = nullptr;
+    size = 0;
+    mappedPath.clear();
+    tableView = ParseTableView();
+}
+
+bool MappedParseTable::saveAs(const std::string& path) const {
+    if (data == nullptr) return false;
+    return replaceFile(path, reinterpret_cast<const char*>(data), size);
+}
+
+bool MappedParseTable::validate(uint64_t expectedHash) {
+    const auto& header = *reinterpret_cast<const ParseTableFileHeader*>(data);
+    if (std::memcmp(header.magic, ParseTableFile::MAGIC, sizeof(ParseTableFile::MAGIC)) != 0) return false;
+    if (header.version != ParseTableFile::VERSION || header.headerSize != sizeof(ParseTableFileHeader)) return false;
+    if (header.grammarHash != expectedHash || header.fileSize != size) return false;
+    if (header.stateCount <= 0 || header.terminalCount <= 0 || header.nonTerminalCount <= 0 ||
+        header.productionCount <= 0 || header.endMarker != header.terminalCount - 1) {
+        return false;
+    }
+
+    // 由计数重新排列各段，与文件头记录的偏移和长度一致才说明文件完整
+    ParseTableFileHeader expected = header;
+    if (layoutSections(expected) != size || std::memcmp(&expected, &header, sizeof(header)) != 0) return false;
+
+    auto section = [this](uint64_t offset) { return data + offset; };
+    tableView.stateCount = header.stateCount;
+    tableView.terminalCount = header.terminalCount;
+    tableView.nonTerminalCount = header.nonTerminalCount;
+    tableView.productionCount = header.productionCount;
+    tableView.endMarker = header.endMarker;
+    tableView.action = reinterpret_cast<const int32_t*>(section(header.actionOffset));
+    tableView.goTo = reinterpret_cast<const int32_t*>(section(header.gotoOffset));
+    tableView.productionLeft = reinterpret_cast<const int32_t*>(section(header.productionLeftOffset));
+    tableView.productionLength = reinterpret_cast<const int32_t*>(section(header.productionLengthOffset));
+    tableView.productionRightOffsets = reinterpret_cast<const uint32_t*>(section(header.productionRightOffsetsOffset));
+    tableView.productionRight = reinterpret_cast<const int32_t*>(section(header.productionRightOffset));
+    tableView.nameOffsets = reinterpret_cast<const uint32_t*>(section(header.nameOffsetsOffset));
+    tableView.nameData = reinterpret_cast<const char*>(section(header.nameDataOffset));
+    tableView.tokenBindingCount = static_cast<int32_t>(header.tokenBindingCount);
+    tableView.tokenBindings = reinterpret_cast<const int32_t*>(section(header.tokenBindingsOffset));
+
+    // 名称与产生式右部的偏移必须落在各自的数据段内
+    int symbolCount = header.terminalCount + header.nonTerminalCount;
+    if (tableView.nameOffsets[symbolCount] != header.nameDataSize) return false;
+    if (tableView.productionRightOffsets[header.productionCount] != header.productionRightCount) return false;
+    for (int symbol = 0; symbol < symbolCount; symbol++) {
+        if (tableView.nameOffsets[symbol] > tableView.nameOffsets[symbol + 1]) return false;
+    }
+    for (int production = 0; production < header.productionCount; production++) {
+        if (tableView.productionRightOffsets[production] > tableView.productionRightOffsets[production + 1]) return false;
+    }
+    for (int type = 0; type < tableView.tokenBindingCount; type++) {
+        int32_t terminal = tableView.tokenBindings[type];
+        if (terminal < -1 || terminal >= header.terminalCount) return false;
+    }
+
+    // 表中的每个值都要在范围内：文件损坏而哈希恰好仍然相符时，analyze也不会越界访问
+    for (int production = 0; production < header.productionCount; production++) {
+        int32_t left = tableView.productionLeft[production];
+        if (left < 0 || left >= header.nonTerminalCount) return false;
+        uint32_t length = tableView.productionRightOffsets[production + 1] - tableView.productionRightOffsets[production];
+        if (tableView.productionLength[production] != static_cast<int32_t>(length)) return false;
+    }
+    for (uint32_t k = 0; k < header.productionRightCount; k++) {
+        int32_t symbol = tableView.productionRight[k];
+        if (symbol < 0 || symbol >= symbolCount) return false;
+    }
+    size_t actionCount = static_cast<size_t>(header.stateCount) * header.terminalCount;
+    for (size_t cell = 0; cell < actionCount; cell++) {
+        int32_t action = tableView.action[cell];
+        if (LRAction::isShift(action) && LRAction::shiftTarget(action) >= header.stateCount) return false;
+        if (LRAction::isReduce(action) && LRAction::reduceProduction(action) >= header.productionCount) return false;
+    }
+    size_t gotoCount = static_cast<size_t>(header.stateCount) * header.nonTerminalCount;
+    for (size_t cell = 0; cell < gotoCount; cell++) {
+        int32_t target = tableView.goTo[cell];
+        if (target < -1 || target >= header.stateCount) return false;
+    }
+    return true;
+}
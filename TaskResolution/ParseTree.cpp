@@ -0,0 +1,40 @@
+#include "ParseTree.h"
+#include <algorithm>
+
+void ParseTree::print(std::ostream& out, const ParseTableView& table, std::span<const std::string> tokenValues) const {
+    if (empty()) return;
+
+    // 用显式栈做先序遍历，树很深时也不会耗尽调用栈；叶子的Token下标在遍历中由tokenCount累加得到
+    struct Pending {
+        uint32_t node;
+        int depth;
+        uint32_t position;
+    };
+    std::vector<Pending> pending = {{rootNode, 0, 0}};
+    while (!pending.empty()) {
+        Pending current = pending.back();
+        pending.pop_back();
+        const ParseTreeNode& currentNode = nodes[current.node];
+
+        out << std::string(static_cast<size_t>(current.depth) * 2, ' ') << table.symbolName(currentNode.symbol);
+        if (currentNode.isLeaf()) {
+            if (currentNode.tokenCount == 1 && current.position < tokenValues.size() &&
+                tokenValues[current.position] != table.symbolName(currentNode.symbol)) {
+                out << " '" << tokenValues[current.position] << "'";
+            }
+        } else if (currentNode.count == 0) {
+            out << " -> ε";
+        }
+        out << "\n";
+
+        // 逆序入栈，子结点按从左到右的顺序打印；错误恢复丢弃的Token计在结点末尾，子结点从开头起算
+        std::span<const uint32_t> childNodes = childrenOf(current.node);
+        size_t base = pending.size();
+        uint32_t position = current.position;
+        for (uint32_t child : childNodes) {
+            pending.push_back({child, current.depth + 1, position});
+            position += nodes[child].tokenCount;
+        }
+        std::reverse(pending.begin() + static_cast<std::ptrdiff_t>(base), pending.end());
+    }
+}
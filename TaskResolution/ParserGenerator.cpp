@@ -0,0 +1,37 @@
+#include "SyntaxAnalyzer.h"
+#include "RecursiveAscentGenerator.h"
+#include <iostream>
+#include <string>
+
+// ParserGenerator <文法文件> <输出文件名（不含扩展名）> <命名空间> [lr1|lalr|minimal]
+int main(int argc, char* argv[]) {
+    if (argc < 4) {
+        std::cerr << "Usage: " << argv[0] << " <grammar> <output-stem> <namespace> [lr1|lalr|minimal]" << std::endl;
+        return 1;
+    }
+
+    SyntaxAnalyzer analyzer;
+    std::string mode = argc > 4 ? argv[4] : "lr1";
+    if (mode == "lalr") {
+        analyzer.setConstructionMode(LALR1);
+    } else if (mode == "minimal") {
+        analyzer.setConstructionMode(MINIMAL_LR1);
+    } else if (mode != "lr1") {
+        std::cerr << "Unknown construction mode: " << mode << std::endl;
+        return 1;
+    }
+
+    std::string grammarPath = argv[1];
+    if (!analyzer.loadGrammar(grammarPath)) {
+        std::cerr << "Failed to load grammar file " << grammarPath << std::endl;
+        return 1;
+    }
+    std::cout << std::endl;
+
+    if (!RecursiveAscentGenerator::generate(analyzer.parseTableView(), argv[2], argv[3], grammarPath)) {
+        return 1;
+    }
+    std::cout << "Generated " << argv[2] << ".h/.cpp with "
+              << analyzer.parseTableView().stateCount << " states" << std::endl;
+    return 0;
+}
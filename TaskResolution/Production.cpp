@@ -1,19 +1,20 @@
 #include "Production.h"
+#include <algorithm>
 
 //处理产生式输出
-std::string Production::toString() const {
-    std::string result = left.name + " -> ";
+std::string Production::toString(const SymbolTable& symbols) const {
+    std::string result = symbols.name(left) + " -> ";
     for (const auto& symbol : right) {
-        result += symbol.name + " ";
+        result += symbols.name(symbol) + " ";
     }
     return result;
 }
 
 bool Production::operator==(const Production& other) const {
-    return left == other.left && right == other.right;
+    return left == other.left && std::ranges::equal(right, other.right);
 }
 
 bool Production::operator<(const Production& other) const {
     if (left != other.left) return left < other.left;
-    return right < other.right;
+    return std::lexicographical_compare(right.begin(), right.end(), other.right.begin(), other.right.end());
 }
\ No newline at end of file
@@ -0,0 +1,225 @@
+#include "RecursiveAscentGenerator.h"
+#include <cctype>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <vector>
+
+namespace {
+    // 符号名作为C++字符串字面量
+    std::string quoted(std::string_view name) {
+        std::string text = "\"";
+        for (char c : name) {
+            if (c == '\\' || c == '"') text += '\\';
+            text += c;
+        }
+        return text + "\"";
+    }
+
+    // 注释中的符号名加上单引号，名称以反斜杠结尾时也不会把下一行接进注释
+    std::string commented(std::string_view name) {
+        return "'" + std::string(name) + "'";
+    }
+
+    std::string productionText(const ParseTableView& table, int production) {
+        std::string text(table.nonTerminalName(table.productionLeft[production]));
+        text += "->";
+        for (uint32_t k = table.productionRightOffsets[production]; k < table.productionRightOffsets[production + 1]; k++) {
+            text += table.symbolName(table.productionRight[k]);
+        }
+        return text;
+    }
+
+    std::string fileName(const std::string& path) {
+        size_t slash = path.find_last_of("/\\");
+        return slash == std::string::npos ? path : path.substr(slash + 1);
+    }
+
+    void writeHeader(std::ostream& out, const ParseTableView& table,
+                     const std::string& parserName, const std::string& sourceName) {
+        std::string guard = "GENERATED_" + parserName + "_PARSER_H";
+        for (char& c : guard) c = static_cast<char>(toupper(static_cast<unsigned char>(c)));
+
+        out << "// 由ParserGenerator根据 " << sourceName << " 生成的递归上升分析器，请勿手工修改\n"
+            << "#ifndef " << guard << "\n"
+            << "#define " << guard << "\n\n"
+            << "#include <cstddef>\n"
+            << "#include <string_view>\n\n"
+            << "namespace " << parserName << " {\n"
+            << "    constexpr int TERMINAL_COUNT = " << table.terminalCount << ";\n"
+            << "    constexpr int END_MARKER = " << table.endMarker << ";  // 结束符号#，输入末尾不需要给出\n"
+            << "    constexpr int PRODUCTION_COUNT = " << table.productionCount << ";\n\n"
+            << "    // 按名称查找终结符编号，不存在时返回-1\n"
+            << "    int terminalId(std::string_view name);\n"
+            << "    // 文法中%bind指令给出的Token类型对应的终结符编号，没有绑定时返回-1\n"
+            << "    int boundTerminal(int tokenType);\n"
+            << "    // 产生式的文本形式，如 E->E+T\n"
+            << "    const char* productionText(int production);\n\n"
+            << "    struct ParseResult {\n"
+            << "        bool accepted;\n"
+            << "        size_t errorPosition;  // 出错时为出错的输入位置，等于count表示在#上出错\n"
+            << "        int errorState;        // 出错时所在的状态，接受时为-1\n"
+            << "    };\n\n"
+            << "    // 分析终结符编号序列，每次规约时以产生式编号调用onReduce\n"
+            << "    ParseResult parse(const int* tokens, size_t count,\n"
+            << "                      void (*onReduce)(int production, void* user) = nullptr, void* user = nullptr);\n"
+            << "}\n\n"
+            << "#endif //" << guard << "\n";
+    }
+
+    void writeState(std::ostream& out, const ParseTableView& table, int state) {
+        out << "    bool state" << state << "(Context& c, Reduction& r) {\n"
+            << "        switch (c.lookahead()) {\n";
+
+        // 动作相同的终结符合并为同一分支
+        std::map<int32_t, std::vector<int>> terminalsByAction;
+        std::vector<int32_t> actionOrder;
+        for (int terminal = 0; terminal < table.terminalCount; terminal++) {
+            int32_t action = table.actionAt(state, terminal);
+            if (action == LRAction::ERROR) continue;
+            auto& group = terminalsByAction[action];
+            if (group.empty()) actionOrder.push_back(action);
+            group.push_back(terminal);
+        }
+        for (int32_t action : actionOrder) {
+            for (int terminal : terminalsByAction[action]) {
+                out << "        case " << terminal << ":  // " << commented(table.symbolName(terminal)) << "\n";
+            }
+            if (LRAction::isShift(action)) {
+                out << "            c.shift();\n"
+                    << "            if (!state" << LRAction::shiftTarget(action) << "(c, r)) return false;\n"
+                    << "            break;\n";
+            } else if (LRAction::isReduce(action)) {
+                int production = LRAction::reduceProduction(action);
+                out << "            c.reduce(" << production << ");  // " << commented(productionText(table, production)) << "\n"
+                    << "            r.left = " << table.productionLeft[production] << ";\n"
+                    << "            r.remaining = " << table.productionLength[production] << ";\n"
+                    << "            break;\n";
+            } else {
+                out << "            r.remaining = ACCEPTED;\n"
+                    << "            break;\n";
+            }
+        }
+        out << "        default:\n"
+            << "            return c.fail(" << state << ");\n"
+            << "        }\n\n";
+
+        // 规约逐层返回，剩余长度为0时当前状态就是句柄下方的状态，按左部转移后继续
+        std::vector<std::pair<int, int>> gotos;
+        for (int nonTerminal = 0; nonTerminal < table.nonTerminalCount; nonTerminal++) {
+            int target = table.gotoAt(state, nonTerminal);
+            if (target >= 0) gotos.emplace_back(nonTerminal, target);
+        }
+        if (gotos.empty()) {
+            out << "        if (r.remaining == 0) return c.fail(" << state << ");\n"
+                << "        if (r.remaining != ACCEPTED) r.remaining--;\n"
+                << "        return true;\n";
+        } else {
+            out << "        for (;;) {\n"
+                << "            if (r.remaining != 0) {\n"
+                << "                if (r.remaining != ACCEPTED) r.remaining--;\n"
+                << "                return true;\n"
+                << "            }\n"
+                << "            switch (r.left) {\n";
+            for (const auto& [nonTerminal, target] : gotos) {
+                out << "            case " << nonTerminal << ":  // " << commented(table.nonTerminalName(nonTerminal)) << "\n"
+                    << "                if (!state" << target << "(c, r)) return false;\n"
+                    << "                break;\n";
+            }
+            out << "            default:\n"
+                << "                return c.fail(" << state << ");\n"
+                << "            }\n"
+                << "        }\n";
+        }
+        out << "    }\n\n";
+    }
+
+    void writeSource(std::ostream& out, const ParseTableView& table, const std::string& headerName,
+                     const std::string& parserName, const std::string& sourceName) {
+        out << "// 由ParserGenerator根据 " << sourceName << " 生成的递归上升分析器，请勿手工修改\n"
+            << "#include \"" << headerName << "\"\n\n"
+            << "namespace " << parserName << " {\n"
+            << "namespace {\n"
+            << "    const char* const terminalNames[] = {";
+        for (int terminal = 0; terminal < table.terminalCount; terminal++) {
+            out << (terminal ? ", " : "") << quoted(table.symbolName(terminal));
+        }
+        out << "};\n";
+        // 数组至少有一项，没有%bind指令的文法也能编译
+        out << "    constexpr int TOKEN_BINDING_COUNT = " << table.tokenBindingCount << ";\n"
+            << "    const int tokenBindings[] = {";
+        for (int type = 0; type < table.tokenBindingCount; type++) out << (type ? ", " : "") << table.tokenBindings[type];
+        out << (table.tokenBindingCount ? "" : "-1") << "};\n"
+            << "    const char* const productionTexts[] = {\n";
+        for (int production = 0; production < table.productionCount; production++) {
+            out << "        " << quoted(productionText(table, production)) << ",\n";
+        }
+        out << "    };\n\n"
+            << "    constexpr int ACCEPTED = -1;  // 接受时沿调用链一直返回\n\n"
+            << "    // 待完成的规约：左部非终结符，以及还需要返回的状态函数个数\n"
+            << "    struct Reduction {\n"
+            << "        int left = 0;\n"
+            << "        int remaining = 0;\n"
+            << "    };\n\n"
+            << "    struct Context {\n"
+            << "        const int* tokens;\n"
+            << "        size_t count;\n"
+            << "        size_t position;\n"
+            << "        void (*onReduce)(int, void*);\n"
+            << "        void* user;\n"
+            << "        int errorState;\n\n"
+            << "        int lookahead() const { return position < count ? tokens[position] : END_MARKER; }\n"
+            << "        void shift() { position++; }\n"
+            << "        void reduce(int production) { if (onReduce) onReduce(production, user); }\n"
+            << "        bool fail(int state) {\n"
+            << "            errorState = state;\n"
+            << "            return false;\n"
+            << "        }\n"
+            << "    };\n\n";
+        for (int state = 0; state < table.stateCount; state++) {
+            out << "    bool state" << state << "(Context& c, Reduction& r);\n";
+        }
+        out << "\n";
+        for (int state = 0; state < table.stateCount; state++) {
+            writeState(out, table, state);
+        }
+        out << "}\n\n"
+            << "int terminalId(std::string_view name) {\n"
+            << "    for (int terminal = 0; terminal < TERMINAL_COUNT; terminal++) {\n"
+            << "        if (terminal != END_MARKER && name == terminalNames[terminal]) return terminal;\n"
+            << "    }\n"
+            << "    return -1;\n"
+            << "}\n\n"
+            << "int boundTerminal(int tokenType) {\n"
+            << "    return tokenType >= 0 && tokenType < TOKEN_BINDING_COUNT ? tokenBindings[tokenType] : -1;\n"
+            << "}\n\n"
+            << "const char* productionText(int production) {\n"
+            << "    return production >= 0 && production < PRODUCTION_COUNT ? productionTexts[production] : \"\";\n"
+            << "}\n\n"
+            << "ParseResult parse(const int* tokens, size_t count, void (*onReduce)(int production, void* user), void* user) {\n"
+            << "    Context c{tokens, count, 0, onReduce, user, -1};\n"
+            << "    Reduction r;\n"
+            << "    if (!state0(c, r)) return {false, c.position, c.errorState};\n"
+            << "    return {true, c.position, -1};\n"
+            << "}\n"
+            << "}\n";
+    }
+}
+
+bool RecursiveAscentGenerator::generate(const ParseTableView& table, const std::string& outputStem,
+                                        const std::string& parserName, const std::string& sourceName) {
+    if (table.stateCount == 0) {
+        std::cerr << "Error: No parse table to generate a parser from" << std::endl;
+        return false;
+    }
+
+    std::ofstream header(outputStem + ".h");
+    std::ofstream source(outputStem + ".cpp");
+    if (!header.is_open() || !source.is_open()) {
+        std::cerr << "Error: Cannot write generated parser " << outputStem << std::endl;
+        return false;
+    }
+    writeHeader(header, table, parserName, sourceName);
+    writeSource(source, table, fileName(outputStem) + ".h", parserName, sourceName);
+    return static_cast<bool>(header) && static_cast<bool>(source);
+}
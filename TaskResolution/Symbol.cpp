@@ -1,3 +1,31 @@
 //
 // Created by 13683 on 25-4-21.
 //
+#include "Symbol.h"
+
+SymbolTable::SymbolTable() {
+    clear();
+}
+
+void SymbolTable::clear() {
+    for (int type = 0; type < 4; type++) {
+        names[type].clear();
+        ids[type].clear();
+    }
+    // ε与#的编号固定为0，与EPSILON_SYMBOL/END_SYMBOL对应
+    intern("ε", EPSILON);
+    intern("#", END_MARKER);
+}
+
+Symbol SymbolTable::intern(const std::string& name, SymbolType type) {
+    auto [it, inserted] = ids[type].try_emplace(name, static_cast<uint32_t>(names[type].size()));
+    if (inserted) names[type].push_back(name);
+    return Symbol(type, it->second);
+}
+
+bool SymbolTable::lookup(std::string_view name, SymbolType type, Symbol& symbol) const {
+    auto it = ids[type].find(name);
+    if (it == ids[type].end()) return false;
+    symbol = Symbol(type, it->second);
+    return true;
+}
@@ -4,76 +4,144 @@
 #include <iostream>
 #include <queue>
 #include <iomanip>
+#include <functional>
+#include <limits>
+#include <algorithm>
+#include <filesystem>
 
 SyntaxAnalyzer::SyntaxAnalyzer() {
     // 添加增广文法的开始符号
-    Symbol startSymbol("S'", NON_TERMINAL);
+    Symbol startSymbol = symbols.intern("S'", NON_TERMINAL);
     nonTerminals.insert(startSymbol);
 }
 
 bool SyntaxAnalyzer::loadGrammar(const std::string& filename) {
     std::ifstream file(filename);
     if (!file.is_open()) return false;
+    if (!hashGrammarFile(filename, grammarHash)) return false;
 
     // 清空之前的数据
+    grammarFile = filename;
     productions.clear();
     terminals.clear();
     nonTerminals.clear();
     states.clear();
     actionTable.clear();
     gotoTable.clear();
+    symbols.clear();
+    rhsPool.clear();
 
-    // 读取第一行获取原始文法的开始符号
+    // 第一条产生式的左部是原始文法的开始符号，%开头的指令行不算产生式
     std::string line;
-    std::getline(file, line);
+    while (std::getline(file, line) && (line.empty() || line[0] == '%')) {}
     std::istringstream firstLine(line);
-    std::string leftStr, arrow;
-    firstLine >> leftStr >> arrow;
-    Symbol originalStart(leftStr, NON_TERMINAL);
-
-    // 添加增广文法：S' -> E
-    Symbol startSymbol("S'", NON_TERMINAL);
-    nonTerminals.insert(startSymbol);
-    productions.emplace_back(startSymbol, std::vector<Symbol>{originalStart}, 0);
+    std::string startName, arrow;
+    firstLine >> startName >> arrow;
 
     // 重置文件指针到开始
     file.clear();
     file.seekg(0);
 
-    int productionIndex = 1;  // 从1开始，因为0已经用于增广产生式
+    // 先读出全部产生式的符号名
+    struct GrammarLine {
+        std::string left;
+        std::vector<std::pair<std::string, SymbolType>> right;
+    };
+    std::vector<GrammarLine> grammarLines;
+    std::set<std::string> terminalNames;
+    std::set<std::string> nonTerminalNames = {"S'", startName};
+    std::vector<std::pair<int, std::string>> bindingNames;  // %bind指令：Token类型 -> 终结符名
 
     while (std::getline(file, line)) {
         if (line.empty() || line[0] == '#') continue;
 
+        // %bind <Token类型> <终结符>：该类型的Token在名称不是终结符时按这个终结符分析
+        if (line[0] == '%') {
+            std::istringstream directive(line);
+            std::string command, typeName, terminalName;
+            directive >> command >> typeName >> terminalName;
+            if (command != "%bind" || terminalName.empty()) {
+                std::cerr << "Error: Unknown grammar directive: " << line << std::endl;
+                return false;
+            }
+            auto type = std::find(std::begin(TOKEN_TYPE_NAMES), std::end(TOKEN_TYPE_NAMES), typeName);
+            if (type == std::end(TOKEN_TYPE_NAMES)) {
+                std::cerr << "Error: Unknown token type in %bind: " << typeName << std::endl;
+                return false;
+            }
+            bindingNames.emplace_back(static_cast<int>(type - std::begin(TOKEN_TYPE_NAMES)), terminalName);
+            continue;
+        }
+
         std::istringstream iss(line);
         std::string leftStr, arrow;
         iss >> leftStr >> arrow;
 
         if (arrow != "->") continue;
 
-        // 创建左侧非终结符
-        Symbol left(leftStr, NON_TERMINAL);
-        nonTerminals.insert(left);
+        GrammarLine grammarLine{leftStr, {}};
+        nonTerminalNames.insert(leftStr);
 
         // 读取右侧符号
-        std::vector<Symbol> rightSymbols;
         std::string symbol;
         while (iss >> symbol) {
-            SymbolType type = isupper(symbol[0]) ? NON_TERMINAL : TERMINAL;
-            rightSymbols.emplace_back(symbol, type);
-            if (type == TERMINAL) terminals.insert(Symbol(symbol, TERMINAL));
+            SymbolType type = isupper(static_cast<unsigned char>(symbol[0])) ? NON_TERMINAL : TERMINAL;
+            grammarLine.right.emplace_back(symbol, type);
+            (type == TERMINAL ? terminalNames : nonTerminalNames).insert(symbol);
+        }
+        grammarLines.push_back(std::move(grammarLine));
+    }
+
+    // 按名称顺序登记符号，句柄的大小顺序与按名称排序一致，各种输出的顺序不受影响
+    for (const auto& name : terminalNames) symbols.intern(name, TERMINAL);
+    for (const auto& name : nonTerminalNames) symbols.intern(name, NON_TERMINAL);
+
+    // 所有产生式的右部依次存放在符号池中，符号池填好后再创建指向它的产生式
+    std::vector<std::pair<Symbol, size_t>> lefts;  // 左部及右部在符号池中的起始位置
+    Symbol startSymbol = symbols.intern("S'", NON_TERMINAL);
+    nonTerminals.insert(startSymbol);
+    lefts.emplace_back(startSymbol, rhsPool.size());
+    rhsPool.push_back(symbols.intern(startName, NON_TERMINAL));  // 增广文法：S' -> E
+
+    for (const auto& grammarLine : grammarLines) {
+        // 创建左侧非终结符
+        Symbol left = symbols.intern(grammarLine.left, NON_TERMINAL);
+        nonTerminals.insert(left);
+        lefts.emplace_back(left, rhsPool.size());
+        for (const auto& [name, type] : grammarLine.right) {
+            Symbol symbol = symbols.intern(name, type);
+            rhsPool.push_back(symbol);
+            if (type == TERMINAL) terminals.insert(symbol);
         }
+    }
 
-        // 添加产生式
-        productions.emplace_back(left, rightSymbols, productionIndex++);
+    // 添加产生式，0号为增广产生式
+    for (size_t i = 0; i < lefts.size(); i++) {
+        size_t end = i + 1 < lefts.size() ? lefts[i + 1].second : rhsPool.size();
+        std::span<const Symbol> right(rhsPool.data() + lefts[i].second, end - lefts[i].second);
+        productions.emplace_back(lefts[i].first, right, static_cast<int>(i));
     }
 
     // 添加终止符号到终结符集合
-    terminals.insert(Symbol("#", END_MARKER));
+    terminals.insert(END_SYMBOL);
+
+    // 绑定的终结符必须出现在产生式中，否则该类型的Token仍按名称分析
+    tokenBindings.clear();
+    for (const auto& [type, terminalName] : bindingNames) {
+        if (!terminalNames.count(terminalName)) {
+            std::cerr << "Warning: %bind " << TOKEN_TYPE_NAMES[type] << " " << terminalName
+                      << " ignored, terminal not used in grammar" << std::endl;
+            continue;
+        }
+        tokenBindings[type] = symbols.intern(terminalName, TERMINAL);
+    }
 
     // 构建First和Follow集
+    numberTerminals();
+    computeNullable();
     computeFirstSets();
     computeFollowSets();
+    indexProductions();
 
     // 构建分析表
     constructParsingTables();
@@ -81,473 +149,1342 @@ bool SyntaxAnalyzer::loadGrammar(const std::string& filename) {
     return true;
 }
 
-void SyntaxAnalyzer::initializeFirstSets() {
-    // 初始化所有终结符的First集
-    for (const auto& terminal : terminals) {
-        firstSets[terminal].insert(terminal);
-    }
+namespace {
+    /*
+     * DeRemer–Pennello的digraph算法：已知每个结点的初值F'(x)和关系R，求
+     *     F(x) = F'(x) ∪ ⋃{ F(y) | x R y }
+     * 用Tarjan算法一次深度优先遍历求出强连通分量，同一分量中的结点集合相同，
+     * 每条边只做一次集合并，总时间与关系的大小成线性。
+     */
+    void digraph(const std::vector<std::vector<int>>& relation, std::vector<TerminalSet>& sets) {
+        const int done = std::numeric_limits<int>::max();
+        std::vector<int> depth(relation.size(), 0);
+        std::vector<int> stack;
+
+        std::function<void(int)> traverse = [&](int x) {
+            stack.push_back(x);
+            int d = static_cast<int>(stack.size());
+            depth[x] = d;
+            for (int y : relation[x]) {
+                if (depth[y] == 0) traverse(y);
+                depth[x] = std::min(depth[x], depth[y]);
+                sets[x].merge(sets[y]);
+            }
+            // x是强连通分量的根，分量中的其他结点取与x相同的集合
+            if (depth[x] == d) {
+                while (true) {
+                    int top = stack.back();
+                    stack.pop_back();
+                    depth[top] = done;
+                    if (top == x) break;
+                    sets[top] = sets[x];
+                }
+            }
+        };
 
-    // 初始化所有非终结符的First集为空集
-    for (const auto& nonTerminal : nonTerminals) {
-        firstSets[nonTerminal] = std::set<Symbol>();
+        for (size_t x = 0; x < relation.size(); x++) {
+            if (depth[x] == 0) traverse(static_cast<int>(x));
+        }
     }
-
-    // 处理空符号
-    Symbol epsilon("ε", EPSILON);
-    firstSets[epsilon].insert(epsilon);
 }
 
-bool SyntaxAnalyzer::addToFirstSet(const Symbol& symbol, const Symbol& firstSymbol) {
-    // 如果First集中已经有这个符号，返回false表示没有变化
-    if (firstSets[symbol].count(firstSymbol) > 0) {
-        return false;
+void SyntaxAnalyzer::numberTerminals() {
+    // 终结符按集合顺序编号，结束符号#排在最后，与稠密分析表的列顺序一致
+    terminalIds.clear();
+    terminalSymbols.assign(terminals.begin(), terminals.end());
+    for (size_t id = 0; id < terminalSymbols.size(); id++) {
+        terminalIds[terminalSymbols[id]] = static_cast<int>(id);
     }
-    // 否则添加到First集中，返回true表示有变化
-    firstSets[symbol].insert(firstSymbol);
-    return true;
 }
 
-void SyntaxAnalyzer::computeFirstSets() {
-    // 步骤1: 初始化First集
-    initializeFirstSets();
+void SyntaxAnalyzer::computeNullable() {
+    // 每个产生式记录右部中尚未确定可空的符号个数，减到0时左部可空；
+    // 含有终结符的产生式永远不会减到0。每个符号出现只处理一次
+    nullable.assign(symbols.count(NON_TERMINAL), 0);
+    std::vector<size_t> remaining(productions.size());
+    std::vector<std::vector<int>> occurrences(symbols.count(NON_TERMINAL));
+    std::vector<int> workList;
 
-    // 步骤2: 重复计算直到没有变化
-    bool changed;
-    do {
-        changed = false;
-
-        // 遍历所有产生式
-        for (const auto& prod : productions) {
-            const Symbol& leftSymbol = prod.left;
+    for (const auto& prod : productions) {
+        remaining[prod.index] = prod.right.size();
+        for (const auto& symbol : prod.right) {
+            if (symbol.type() == NON_TERMINAL) occurrences[symbol.index()].push_back(prod.index);
+            else remaining[prod.index] = std::numeric_limits<size_t>::max();
+        }
+        if (prod.right.empty() && !nullable[prod.left.index()]) {
+            nullable[prod.left.index()] = 1;
+            workList.push_back(static_cast<int>(prod.left.index()));
+        }
+    }
 
-            // 如果右部为空，将ε加入到左部符号的First集中
-            if (prod.right.empty()) {
-                Symbol epsilon("ε", EPSILON);
-                changed |= addToFirstSet(leftSymbol, epsilon);
-                continue;
+    while (!workList.empty()) {
+        int symbol = workList.back();
+        workList.pop_back();
+        for (int prodIndex : occurrences[symbol]) {
+            if (--remaining[prodIndex] != 0) continue;
+            uint32_t left = productions[prodIndex].left.index();
+            if (!nullable[left]) {
+                nullable[left] = 1;
+                workList.push_back(static_cast<int>(left));
             }
+        }
+    }
+}
 
-            // 处理右部符号序列
-            bool allCanBeEmpty = true;
-            for (size_t i = 0; i < prod.right.size(); ++i) {
-                const Symbol& currentSymbol = prod.right[i];
-                allCanBeEmpty = false;
+void SyntaxAnalyzer::computeFirstSets() {
+    // 初值：A -> αaβ 且α可空时 a ∈ First(A)；关系：A -> αBβ 且α可空时 First(A) ⊇ First(B)
+    size_t count = symbols.count(NON_TERMINAL);
+    firstSets.assign(count, TerminalSet());
+    std::vector<std::vector<int>> includes(count);
 
-                // 如果是终结符，直接添加到左部的First集
-                if (currentSymbol.type == TERMINAL) {
-                    changed |= addToFirstSet(leftSymbol, currentSymbol);
-                    break;
-                }
+    for (const auto& prod : productions) {
+        int left = static_cast<int>(prod.left.index());
+        for (const auto& symbol : prod.right) {
+            if (symbol.type() != NON_TERMINAL) {
+                firstSets[left].insert(terminalIds.at(symbol));
+                break;
+            }
+            includes[left].push_back(static_cast<int>(symbol.index()));
+            if (!nullable[symbol.index()]) break;
+        }
+    }
 
-                // 将当前符号的First集（除去ε）添加到左部符号的First集
-                for (const auto& firstSymbol : firstSets[currentSymbol]) {
-                    if (firstSymbol.type != EPSILON) {
-                        changed |= addToFirstSet(leftSymbol, firstSymbol);
-                    }
-                }
+    digraph(includes, firstSets);
+}
 
-                // 检查当前符号是否可以推导出ε
-                bool hasEpsilon = false;
-                for (const auto& firstSymbol : firstSets[currentSymbol]) {
-                    if (firstSymbol.type == EPSILON) {
-                        hasEpsilon = true;
-                        allCanBeEmpty = true;
-                        break;
-                    }
-                }
+void SyntaxAnalyzer::computeFollowSets() {
+    // 初值：A -> αBβ 时 First(β) ⊆ Follow(B)，开始符号的Follow集含有#；
+    // 关系：A -> αBβ 且β可空时 Follow(B) ⊇ Follow(A)
+    size_t count = symbols.count(NON_TERMINAL);
+    followSets.assign(count, TerminalSet());
+    std::vector<std::vector<int>> includes(count);
+    followSets[productions[0].left.index()].insert(terminalIds.at(END_SYMBOL));
 
-                // 如果当前符号不能推导出ε，停止处理
-                if (!hasEpsilon) {
-                    break;
-                }
+    for (const auto& prod : productions) {
+        // 从右向左扫描，同时维护后缀β的First集和可空性
+        TerminalSet firstOfRest;
+        bool restNullable = true;
+        for (size_t i = prod.right.size(); i-- > 0;) {
+            const Symbol& currentSymbol = prod.right[i];
+            if (currentSymbol.type() != NON_TERMINAL) {
+                firstOfRest = TerminalSet();
+                firstOfRest.insert(terminalIds.at(currentSymbol));
+                restNullable = false;
+                continue;
             }
 
-            // 如果所有符号都可以推导出ε，将ε加入到左部符号的First集
-            if (allCanBeEmpty) {
-                Symbol epsilon("ε", EPSILON);
-                changed |= addToFirstSet(leftSymbol, epsilon);
+            followSets[currentSymbol.index()].merge(firstOfRest);
+            if (restNullable) includes[currentSymbol.index()].push_back(static_cast<int>(prod.left.index()));
+
+            if (!nullable[currentSymbol.index()]) {
+                firstOfRest = firstSets[currentSymbol.index()];
+                restNullable = false;
+            } else {
+                firstOfRest.merge(firstSets[currentSymbol.index()]);
             }
         }
-    } while (changed); // 当没有变化时停止迭代
+    }
+
+    digraph(includes, followSets);
 }
 
-// 计算符号序列的First集
-std::set<Symbol> SyntaxAnalyzer::getFirstOfSymbolSequence(const std::vector<Symbol>& symbols) {
-    std::set<Symbol> result;
+std::string SyntaxAnalyzer::formatTerminalSet(const TerminalSet& set, bool withEpsilon) const {
+    // 按符号顺序输出：终结符、ε、结束符号#
+    std::string result;
+    bool epsilonPrinted = !withEpsilon;
+    set.forEach([&](int id) {
+        if (!epsilonPrinted && terminalSymbols[id].type() == END_MARKER) {
+            result += symbols.name(EPSILON_SYMBOL) + " ";
+            epsilonPrinted = true;
+        }
+        result += symbols.name(terminalSymbols[id]) + " ";
+    });
+    if (!epsilonPrinted) result += symbols.name(EPSILON_SYMBOL) + " ";
+    return result;
+}
 
-    if (symbols.empty()) {
-        Symbol epsilon("ε", EPSILON);
-        result.insert(epsilon);
-        return result;
+void SyntaxAnalyzer::indexProductions() {
+    // 按左部索引产生式，求闭包时直接取出某个非终结符的全部产生式
+    productionsByLeft.clear();
+    for (const auto& prod : productions) {
+        productionsByLeft[prod.left].push_back(prod.index);
     }
 
-    bool allCanBeEmpty = true;
-
-    for (const auto& symbol : symbols) {
-        allCanBeEmpty = false;
-
-        // 添加当前符号的First集（除去ε）
-        for (const auto& firstSymbol : firstSets[symbol]) {
-            if (firstSymbol.type != EPSILON) {
-                result.insert(firstSymbol);
+    // 预先求出每个产生式每个位置之后的符号串的First集（不含ε）以及它能否推导出ε
+    suffixFirstSets.assign(productions.size(), {});
+    suffixNullable.assign(productions.size(), {});
+    for (const auto& prod : productions) {
+        auto& suffixes = suffixFirstSets[prod.index];
+        auto& suffixIsNullable = suffixNullable[prod.index];
+        suffixes.resize(prod.right.size() + 1);
+        suffixIsNullable.resize(prod.right.size() + 1);
+        suffixIsNullable[prod.right.size()] = 1;
+        for (size_t dot = prod.right.size(); dot-- > 0;) {
+            const Symbol& symbol = prod.right[dot];
+            if (symbol.type() != NON_TERMINAL) {
+                suffixes[dot].insert(terminalIds.at(symbol));
+                continue;
             }
-        }
-
-        // 检查是否可以继续处理下一个符号
-        bool hasEpsilon = false;
-        for (const auto& firstSymbol : firstSets[symbol]) {
-            if (firstSymbol.type == EPSILON) {
-                hasEpsilon = true;
-                allCanBeEmpty = true;
-                break;
+            suffixes[dot] = firstSets[symbol.index()];
+            if (nullable[symbol.index()]) {
+                suffixes[dot].merge(suffixes[dot + 1]);
+                suffixIsNullable[dot] = suffixIsNullable[dot + 1];
             }
         }
+    }
+}
 
-        if (!hasEpsilon) break;
+std::set<LR1Item> SyntaxAnalyzer::closure(const std::set<LR1Item>& items) const {
+    std::map<std::pair<int, size_t>, TerminalSet> mergedItems;
+    std::vector<std::pair<int, size_t>> workList;
+
+    // 初始化：合并输入项目的向前看符号
+    for (const auto& item : items) {
+        auto key = std::make_pair(item.prod.index, item.dotPosition);
+        mergedItems[key].merge(item.lookahead);
+        workList.push_back(key);
     }
 
-    // 如果所有符号都可以推导出ε，将ε加入结果集
-    if (allCanBeEmpty) {
-        Symbol epsilon("ε", EPSILON);
-        result.insert(epsilon);
+    // 只有向前看符号增加的项目才需要重新处理
+    while (!workList.empty()) {
+        auto key = workList.back();
+        workList.pop_back();
+        const Production& prod = productions[key.first];
+        size_t dotPos = key.second;
+
+        // 点号后面不是非终结符，不产生新项目
+        if (dotPos >= prod.right.size() || prod.right[dotPos].type() != NON_TERMINAL) continue;
+        auto alternatives = productionsByLeft.find(prod.right[dotPos]);
+        if (alternatives == productionsByLeft.end()) continue;
+
+        // 新项目的向前看符号为First(βa)，只有β可以推导出ε时才包含当前项目的向前看符号
+        TerminalSet lookahead = suffixFirstSets[key.first][dotPos + 1];
+        if (suffixNullable[key.first][dotPos + 1]) lookahead.merge(mergedItems[key]);
+
+        // 为该非终结符的每个产生式添加新项目
+        for (int newProd : alternatives->second) {
+            auto newKey = std::make_pair(newProd, size_t(0));
+            auto [target, created] = mergedItems.try_emplace(newKey);
+            if (target->second.merge(lookahead) || created) workList.push_back(newKey);
+        }
     }
 
-    return result;
-}
-void SyntaxAnalyzer::initializeFollowSets() {
-    // 为所有非终结符初始化空的Follow集
-    for (const auto& nonTerminal : nonTerminals) {
-        followSets[nonTerminal] = std::set<Symbol>();
+    // 构造结果集
+    std::set<LR1Item> result;
+    for (const auto& [key, lookAhead] : mergedItems) {
+        result.insert(LR1Item(productions[key.first], key.second, lookAhead));
     }
 
-    // 为开始符号的Follow集加入结束符号#
-    Symbol startSymbol("S'", NON_TERMINAL);
-    Symbol endMarker("#", END_MARKER);
-    followSets[startSymbol].insert(endMarker);
+    return result;
 }
 
-bool SyntaxAnalyzer::addToFollowSet(const Symbol& symbol, const Symbol& followSymbol) {
-    // 不将ε加入Follow集
-    if (followSymbol.type == EPSILON) {
-        return false;
+std::vector<std::pair<Symbol, std::set<LR1Item>>> SyntaxAnalyzer::goToKernels(const std::set<LR1Item>& items) const {
+    // 一次遍历把可以移进的项目按下一个符号分组，符号按首次出现的顺序排列，
+    // 保证后继状态的编号顺序与逐个项目求GOTO时一致
+    std::vector<std::pair<Symbol, std::map<std::pair<int, size_t>, TerminalSet>>> groups;
+    std::map<Symbol, size_t> groupOf;
+    for (const auto& item : items) {
+        if (item.isComplete()) continue;
+        Symbol next = item.getNextSymbol();
+        auto [it, inserted] = groupOf.try_emplace(next, groups.size());
+        if (inserted) groups.emplace_back(next, std::map<std::pair<int, size_t>, TerminalSet>());
+        groups[it->second].second[{item.prod.index, item.dotPosition + 1}].merge(item.lookahead);
     }
 
-    // 如果Follow集中已经有这个符号，返回false表示没有变化
-    if (followSets[symbol].count(followSymbol) > 0) {
-        return false;
+    // 构造各后继状态的核心项目集
+    std::vector<std::pair<Symbol, std::set<LR1Item>>> kernels;
+    for (const auto& [symbol, mergedItems] : groups) {
+        std::set<LR1Item> newItems;
+        for (const auto& [key, lookAhead] : mergedItems) {
+            newItems.insert(LR1Item(productions[key.first], key.second, lookAhead));
+        }
+        kernels.emplace_back(symbol, std::move(newItems));
     }
+    return kernels;
+}
 
-    // 否则添加到Follow集中，返回true表示有变化
-    followSets[symbol].insert(followSymbol);
-    return true;
+size_t StateKernelHash::operator()(const StateKernel& kernel) const {
+    size_t seed = kernel.size();
+    auto combine = [&seed](size_t value) {
+        seed ^= value + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2);
+    };
+    for (const auto& item : kernel) {
+        combine(static_cast<size_t>(item.production));
+        combine(item.dotPosition);
+        combine(item.lookahead.hash());
+    }
+    return seed;
 }
 
-bool SyntaxAnalyzer::addToFollowSet(const Symbol& symbol, const std::set<Symbol>& followSymbols) {
-    bool changed = false;
-    for (const auto& followSymbol : followSymbols) {
-        // 不将ε加入Follow集
-        if (followSymbol.type != EPSILON) {
-            changed |= addToFollowSet(symbol, followSymbol);
+StateKernel SyntaxAnalyzer::kernelOf(const std::set<LR1Item>& items) {
+    StateKernel kernel;
+    for (const auto& item : items) {
+        if (item.dotPosition > 0 || item.prod.index == 0) {
+            kernel.push_back({item.prod.index, item.dotPosition, item.lookahead});
         }
     }
-    return changed;
+    return kernel;
 }
 
-void SyntaxAnalyzer::computeFollowSets() {
-    // 步骤1: 初始化Follow集
-    initializeFollowSets();
+void SyntaxAnalyzer::buildLR1Automaton() {
+    states.clear();
+    actionTable.clear();
+    gotoTable.clear();
 
-    // 步骤2: 重复计算直到没有变化
-    bool changed;
-    do {
-        changed = false;
+    // 创建初始项目集
+    const Production& augmentedProd = productions[0];
+    TerminalSet initialLookahead;
+    initialLookahead.insert(terminalIds.at(END_SYMBOL));
+    LR1Item startItem(augmentedProd, 0, initialLookahead);
+    states[0] = {startItem};
 
-        // 遍历所有产生式
-        for (const auto& prod : productions) {
-            // 遍历产生式右部的每个符号
-            for (size_t i = 0; i < prod.right.size(); i++) {
-                const Symbol& currentSymbol = prod.right[i];
+    // 核心 -> 状态编号，避免每得到一个后继状态都与全部已有状态逐一比较
+    std::unordered_map<StateKernel, int, StateKernelHash> stateIds;
+    stateIds.emplace(kernelOf(states[0]), 0);
 
-                // 只处理非终结符
-                if (currentSymbol.type != NON_TERMINAL) {
-                    continue;
-                }
+    std::queue<int> workList;
+    workList.push(0);
 
-                // 如果不是最后一个符号
-                if (i < prod.right.size() - 1) {
-                    // 获取后续符号序列的First集
-                    std::vector<Symbol> restSymbols(prod.right.begin() + i + 1, prod.right.end());
-                    std::set<Symbol> firstOfRest = getFirstOfSymbolSequence(restSymbols);
-
-                    // 将First集加入到当前非终结符的Follow集
-                    changed |= addToFollowSet(currentSymbol, firstOfRest);
-
-                    // 如果后续符号序列可以推导出ε，则将产生式左部的Follow集加入到当前符号的Follow集
-                    bool allCanBeEmpty = true;
-                    for (const auto& symbol : restSymbols) {
-                        bool hasEpsilon = false;
-                        for (const auto& firstSymbol : firstSets[symbol]) {
-                            if (firstSymbol.type == EPSILON) {
-                                hasEpsilon = true;
-                                break;
-                            }
-                        }
-                        if (!hasEpsilon) {
-                            allCanBeEmpty = false;
-                            break;
-                        }
-                    }
-                    if (allCanBeEmpty) {
-                        changed |= addToFollowSet(currentSymbol, followSets[prod.left]);
-                    }
-                }
-                // 如果是最后一个符号，或者后面的符号都可以推导出ε
-                else {
-                    // 将产生式左部的Follow集加入到当前符号的Follow集
-                    changed |= addToFollowSet(currentSymbol, followSets[prod.left]);
-                }
+    while (!workList.empty()) {
+        int currentState = workList.front();
+        workList.pop();
+
+        // 闭包只在处理该状态时临时求出，状态表中只保存核心
+        auto items = closure(states[currentState]);
+
+        // 完成项目填规约动作
+        for (const auto& item : items) {
+            if (item.isComplete()) emitReduction(currentState, item);
+        }
+
+        // 每个符号只求一次后继核心
+        for (auto& [next, kernel] : goToKernels(items)) {
+            // 按核心查找或创建新状态
+            auto [found, inserted] = stateIds.try_emplace(kernelOf(kernel), static_cast<int>(states.size()));
+            int newStateId = found->second;
+            if (inserted) {
+                states[newStateId] = std::move(kernel);
+                workList.push(newStateId);
             }
+
+            // 同一符号的ACTION/GOTO表项一次填好
+            emitTransition(currentState, next, newStateId);
         }
-    } while (changed); // 当没有变化时停止迭代
+    }
 }
 
-std::set<LR1Item> SyntaxAnalyzer::closure(const std::set<LR1Item>& items) {
-    std::map<std::pair<int, size_t>, std::set<Symbol>> mergedItems;
+std::set<std::pair<int, size_t>> SyntaxAnalyzer::lr0Closure(const std::set<std::pair<int, size_t>>& kernel) const {
+    std::set<std::pair<int, size_t>> result = kernel;
+    std::vector<std::pair<int, size_t>> workList(kernel.begin(), kernel.end());
 
-    // 初始化：合并输入项目的向前看符号
-    for (const auto& item : items) {
-        auto key = std::make_pair(item.prod.index, item.dotPosition);
-        mergedItems[key].insert(item.lookahead.begin(), item.lookahead.end());
+    while (!workList.empty()) {
+        auto [prodIndex, dotPos] = workList.back();
+        workList.pop_back();
+        const Production& prod = productions[prodIndex];
+        if (dotPos >= prod.right.size() || prod.right[dotPos].type() != NON_TERMINAL) continue;
+
+        // 点号后面是非终结符，加入它的所有产生式
+        auto alternatives = productionsByLeft.find(prod.right[dotPos]);
+        if (alternatives == productionsByLeft.end()) continue;
+        for (int newProd : alternatives->second) {
+            if (result.insert({newProd, 0}).second) workList.push_back({newProd, 0});
+        }
     }
+    return result;
+}
 
-    bool changed;
-    do {
-        changed = false;
-        std::map<std::pair<int, size_t>, std::set<Symbol>> newItems = mergedItems;
+void SyntaxAnalyzer::buildLALR1Automaton() {
+    /*
+     * LALR(1)构造（龙书算法4.62/4.63）：
+     * 1. 构造LR(0)项目集规范族，每个状态只保存核心项目；
+     * 2. 对每个状态I的每个核心项目K，以一个不属于文法的哑符号作为向前看符号求LR(1)闭包，
+     *    闭包中 [B -> γ·Xδ, a] 移进X后得到GOTO(I, X)的核心项目 [B -> γX·δ]：
+     *    a不是哑符号时，a是该核心项目自发生成的向前看符号；a是哑符号时，K的向前看符号会传播给它；
+     * 3. 从 [S' -> ·S, #] 开始沿传播关系迭代到不再变化，得到每个核心项目的向前看符号。
+     */
+    states.clear();
+    actionTable.clear();
+    gotoTable.clear();
 
-        // 对每个已有项目
-        for (const auto& [key, lookAhead] : mergedItems) {
-            const Production& prod = productions[key.first];
-            size_t dotPos = key.second;
-
-            // 如果点号后面是非终结符
-            if (dotPos < prod.right.size() && prod.right[dotPos].type == NON_TERMINAL) {
-                // 计算后续符号串的First集
-                std::vector<Symbol> beta(prod.right.begin() + dotPos + 1, prod.right.end());
-                std::set<Symbol> firstBeta = getFirstOfSymbolSequence(beta);
-
-                // 如果First(β)为空，使用当前的向前看符号
-                if (firstBeta.empty()) {
-                    firstBeta = lookAhead;
-                } else {
-                    // 移除epsilon并添加向前看符号
-                    firstBeta.erase(Symbol("ε", EPSILON));
-                    firstBeta.insert(lookAhead.begin(), lookAhead.end());
-                }
+    using Core = std::set<std::pair<int, size_t>>;
+    std::vector<Core> kernels = {{{0, 0}}};
+    std::map<Core, int> kernelIds = {{kernels[0], 0}};
+    std::map<std::pair<int, Symbol>, int> transitions;
 
-                // 为该非终结符的每个产生式添加新项目
-                for (const auto& newProd : productions) {
-                    if (newProd.left == prod.right[dotPos]) {
-                        auto newKey = std::make_pair(newProd.index, 0);
-                        size_t oldSize = newItems[newKey].size();
-                        newItems[newKey].insert(firstBeta.begin(), firstBeta.end());
-                        if (newItems[newKey].size() > oldSize) {
-                            changed = true;
-                        }
-                    }
+    // 步骤1: LR(0)项目集规范族
+    for (size_t current = 0; current < kernels.size(); current++) {
+        std::map<Symbol, Core> successors;
+        for (const auto& [prodIndex, dotPos] : lr0Closure(kernels[current])) {
+            const Production& prod = productions[prodIndex];
+            if (dotPos < prod.right.size()) {
+                successors[prod.right[dotPos]].insert({prodIndex, dotPos + 1});
+            }
+        }
+        for (const auto& [symbol, core] : successors) {
+            auto [it, inserted] = kernelIds.emplace(core, static_cast<int>(kernels.size()));
+            if (inserted) kernels.push_back(core);
+            transitions[{static_cast<int>(current), symbol}] = it->second;
+        }
+    }
+
+    // 步骤2: 自发生成的向前看符号与传播关系
+    using KernelItem = std::pair<int, std::pair<int, size_t>>;  // (状态, 核心项目)
+    // 哑符号使用紧接在全部终结符之后的编号
+    const int propagateMarker = static_cast<int>(terminalSymbols.size());
+    TerminalSet probeLookahead;
+    probeLookahead.insert(propagateMarker);
+    std::map<KernelItem, TerminalSet> lookaheads;
+    std::map<KernelItem, std::vector<KernelItem>> propagation;
+    lookaheads[{0, {0, 0}}].insert(terminalIds.at(END_SYMBOL));
+
+    for (size_t current = 0; current < kernels.size(); current++) {
+        for (const auto& kernelItem : kernels[current]) {
+            LR1Item probe(productions[kernelItem.first], kernelItem.second, probeLookahead);
+            for (const auto& item : closure({probe})) {
+                if (item.isComplete()) continue;
+                int target = transitions.at({static_cast<int>(current), item.getNextSymbol()});
+                KernelItem to = {target, {item.prod.index, item.dotPosition + 1}};
+                TerminalSet spontaneous = item.lookahead;
+                if (spontaneous.erase(propagateMarker)) {
+                    propagation[{static_cast<int>(current), kernelItem}].push_back(to);
                 }
+                lookaheads[to].merge(spontaneous);
+            }
+        }
+    }
+
+    // 步骤3: 沿传播关系迭代
+    bool changed;
+    do {
+        changed = false;
+        for (const auto& [from, targets] : propagation) {
+            auto source = lookaheads.find(from);
+            if (source == lookaheads.end()) continue;
+            for (const auto& to : targets) {
+                // source指向的元素在map中的位置不会因插入其他键而改变，to与from相同时merge不会增加元素
+                changed |= lookaheads[to].merge(source->second);
             }
         }
-        mergedItems = newItems;
     } while (changed);
 
-    // 构造结果集
-    std::set<LR1Item> result;
-    for (const auto& [key, lookAhead] : mergedItems) {
-        result.insert(LR1Item(productions[key.first], key.second, lookAhead));
+    // 保存带向前看符号的核心项目，得到LALR(1)项目集
+    for (size_t current = 0; current < kernels.size(); current++) {
+        std::set<LR1Item> kernelItems;
+        for (const auto& kernelItem : kernels[current]) {
+            kernelItems.insert(LR1Item(productions[kernelItem.first], kernelItem.second,
+                                       lookaheads[{static_cast<int>(current), kernelItem}]));
+        }
+        states[static_cast<int>(current)] = std::move(kernelItems);
     }
 
-    return result;
+    fillParsingTables(transitions);
 }
 
-std::set<LR1Item> SyntaxAnalyzer::goTo(const std::set<LR1Item>& items, const Symbol& symbol) {
-    std::map<std::pair<int, size_t>, std::set<Symbol>> mergedItems;
-
-    // 收集所有可以移进的项目
-    for (const auto& item : items) {
-        if (!item.isComplete() && item.getNextSymbol() == symbol) {
-            auto key = std::make_pair(item.prod.index, item.dotPosition + 1);
-            mergedItems[key].insert(item.lookahead.begin(), item.lookahead.end());
+namespace {
+    using LookaheadKernel = std::map<std::pair<int, size_t>, TerminalSet>;
+
+    // Pager弱相容性：两个同心核心的第i、j个项目的向前看符号分别为L_i/L_j与M_i/M_j，
+    // 对任意i != j，若 L_i∩M_j 与 L_j∩M_i 均为空，或 L_i∩L_j 非空，或 M_i∩M_j 非空，则两者弱相容，
+    // 合并弱相容的状态不会引入规范LR(1)中不存在的规约-规约冲突
+    bool weaklyCompatible(const LookaheadKernel& existing, const LookaheadKernel& incoming) {
+        std::vector<const TerminalSet*> l, m;
+        for (const auto& [item, la] : existing) l.push_back(&la);
+        for (const auto& [item, la] : incoming) m.push_back(&la);
+        for (size_t i = 0; i < l.size(); i++) {
+            for (size_t j = i + 1; j < l.size(); j++) {
+                bool crossFree = !l[i]->intersects(*m[j]) && !l[j]->intersects(*m[i]);
+                if (!crossFree && !l[i]->intersects(*l[j]) && !m[i]->intersects(*m[j])) return false;
+            }
         }
+        return true;
     }
-
-    // 构造新项目集
-    std::set<LR1Item> newItems;
-    for (const auto& [key, lookAhead] : mergedItems) {
-        newItems.insert(LR1Item(productions[key.first], key.second, lookAhead));
-    }
-
-    // 返回新项目集的闭包
-    return closure(newItems);
 }
 
-void SyntaxAnalyzer::buildLR1Automaton() {
+void SyntaxAnalyzer::buildMinimalLR1Automaton() {
+    /*
+     * 最小LR(1)构造（Pager弱相容合并）：按规范LR(1)的方式由闭包与后继核心扩展状态，
+     * 但新得到的核心若与某个已有的同心状态弱相容，就把向前看符号并入该状态而不新建状态。
+     * 被并入的状态向前看符号增加后需要重新处理，让新增的向前看符号继续传播给它的后继。
+     * 对LALR(1)文法得到与LALR(1)同样大小的分析表，对LR(1)但非LALR(1)的文法只在必要处拆分状态。
+     */
     states.clear();
     actionTable.clear();
     gotoTable.clear();
 
-    // 创建初始项目集
-    const Production& augmentedProd = productions[0];
-    std::set<Symbol> initialLookahead = {Symbol("#", END_MARKER)};
-    LR1Item startItem(augmentedProd, 0, initialLookahead);
-    states[0] = closure({startItem});
-
+    using Core = std::set<std::pair<int, size_t>>;
+    TerminalSet endLookahead;
+    endLookahead.insert(terminalIds.at(END_SYMBOL));
+    std::vector<LookaheadKernel> kernels = {{{{0, 0}, endLookahead}}};
+    std::map<Core, std::vector<int>> statesOfCore = {{{{0, 0}}, {0}}};
+    std::map<std::pair<int, Symbol>, int> transitions;
     std::queue<int> workList;
+    std::vector<char> queued = {1};
     workList.push(0);
 
+    auto itemsOf = [this](const LookaheadKernel& kernel) {
+        std::set<LR1Item> items;
+        for (const auto& [key, lookahead] : kernel) {
+            items.insert(LR1Item(productions[key.first], key.second, lookahead));
+        }
+        return items;
+    };
+
     while (!workList.empty()) {
-        int currentState = workList.front();
+        int current = workList.front();
         workList.pop();
+        queued[current] = 0;
 
-        // 对当前状态中的每个项目
-        for (const auto& item : states[currentState]) {
-            if (item.isComplete()) {
-                // 特殊处理接受状态
-                if (item.prod.index == 0) {
-                    for (const auto& la : item.lookahead) {
-                        if (la.type == END_MARKER) {
-                            actionTable[{currentState, la}] = "acc";
-                        }
-                    }
-                } else {
-                    // 规约动作
-                    for (const auto& la : item.lookahead) {
-                        actionTable[{currentState, la}] = "r" + std::to_string(item.prod.index);
-                    }
-                }
-                continue;
-            }
-
-            // 获取下一个符号
-            Symbol next = item.getNextSymbol();
-
-            // 计算GOTO结果
-            auto nextState = goTo(states[currentState], next);
-            if (nextState.empty()) continue;
+        // 按下一个符号分组，得到各后继状态的核心项目及其向前看符号
+        std::map<Symbol, LookaheadKernel> successors;
+        for (const auto& item : closure(itemsOf(kernels[current]))) {
+            if (item.isComplete()) continue;
+            successors[item.getNextSymbol()][{item.prod.index, item.dotPosition + 1}].merge(item.lookahead);
+        }
 
-            // 查找或创建新状态
-            int newStateId = -1;
-            for (const auto& [id, existing] : states) {
-                if (existing == nextState) {
-                    newStateId = id;
+        for (const auto& [symbol, kernel] : successors) {
+            Core core;
+            for (const auto& [key, lookahead] : kernel) core.insert(key);
+
+            // 优先尝试原有的转移目标，其次是其他同心状态
+            std::vector<int> candidates;
+            auto previous = transitions.find({current, symbol});
+            if (previous != transitions.end()) candidates.push_back(previous->second);
+            const auto& sameCore = statesOfCore[core];
+            candidates.insert(candidates.end(), sameCore.begin(), sameCore.end());
+
+            int target = -1;
+            for (int candidate : candidates) {
+                if (weaklyCompatible(kernels[candidate], kernel)) {
+                    target = candidate;
                     break;
                 }
             }
-            if (newStateId == -1) {
-                newStateId = states.size();
-                states[newStateId] = nextState;
-                workList.push(newStateId);
-            }
 
-            // 更新分析表
-            if (next.type == TERMINAL || next.type == END_MARKER) {
-                actionTable[{currentState, next}] = "s" + std::to_string(newStateId);
+            if (target == -1) {
+                target = static_cast<int>(kernels.size());
+                kernels.push_back(kernel);
+                statesOfCore[core].push_back(target);
+                queued.push_back(1);
+                workList.push(target);
             } else {
-                gotoTable[{currentState, next}] = newStateId;
+                bool grown = false;
+                for (const auto& [key, lookahead] : kernel) {
+                    grown |= kernels[target][key].merge(lookahead);
+                }
+                if (grown && !queued[target]) {
+                    queued[target] = 1;
+                    workList.push(target);
+                }
             }
+            transitions[{current, symbol}] = target;
+        }
+    }
+
+    // 重新处理时转移目标可能改变，去掉不再可达的状态并按原顺序重新编号
+    std::vector<int> newId(kernels.size(), -1);
+    std::vector<int> reachable = {0};
+    newId[0] = 0;
+    for (size_t k = 0; k < reachable.size(); k++) {
+        for (auto it = transitions.lower_bound({reachable[k], Symbol()});
+             it != transitions.end() && it->first.first == reachable[k]; ++it) {
+            if (newId[it->second] == -1) {
+                newId[it->second] = 0;
+                reachable.push_back(it->second);
+            }
+        }
+    }
+    int nextId = 0;
+    for (size_t id = 0; id < kernels.size(); id++) {
+        if (newId[id] != -1) newId[id] = nextId++;
+    }
+
+    std::map<std::pair<int, Symbol>, int> liveTransitions;
+    for (const auto& [stateSymbol, target] : transitions) {
+        if (newId[stateSymbol.first] == -1) continue;
+        liveTransitions[{newId[stateSymbol.first], stateSymbol.second}] = newId[target];
+    }
+    for (size_t id = 0; id < kernels.size(); id++) {
+        if (newId[id] != -1) states[newId[id]] = itemsOf(kernels[id]);
+    }
+
+    fillParsingTables(liveTransitions);
+}
+
+void SyntaxAnalyzer::fillParsingTables(const std::map<std::pair<int, Symbol>, int>& transitions) {
+    // 空产生式的完成项目不在核心中，需要求闭包才能得到全部规约
+    for (const auto& [stateId, kernel] : states) {
+        for (const auto& item : closure(kernel)) {
+            if (item.isComplete()) emitReduction(stateId, item);
+        }
+    }
+    for (const auto& [stateSymbol, target] : transitions) {
+        emitTransition(stateSymbol.first, stateSymbol.second, target);
+    }
+}
+
+void SyntaxAnalyzer::emitReduction(int state, const LR1Item& item) {
+    item.lookahead.forEach([&](int id) {
+        const Symbol& la = terminalSymbols[id];
+        if (item.prod.index == 0) {
+            // 特殊处理接受状态
+            if (la.type() == END_MARKER) setAction(state, la, "acc");
+        } else {
+            // 规约动作
+            setAction(state, la, "r" + std::to_string(item.prod.index));
         }
+    });
+}
+
+void SyntaxAnalyzer::emitTransition(int state, const Symbol& symbol, int target) {
+    if (symbol.type() == TERMINAL || symbol.type() == END_MARKER) {
+        setAction(state, symbol, "s" + std::to_string(target));
+    } else {
+        gotoTable[{state, symbol}] = target;
     }
 }
 
+namespace {
+    // 冲突解决的优先级：接受 > 移进 > 规约，两个规约之间选择编号较小的产生式
+    bool preferAction(const std::string& candidate, const std::string& current) {
+        auto rank = [](const std::string& action) {
+            return action == "acc" ? 0 : action[0] == 's' ? 1 : 2;
+        };
+        if (rank(candidate) != rank(current)) return rank(candidate) < rank(current);
+        if (candidate[0] == 'r') return std::stoi(candidate.substr(1)) < std::stoi(current.substr(1));
+        return false;
+    }
+
+    int32_t actionCode(const std::string& action) {
+        if (action == "acc") return LRAction::ACCEPT;
+        if (action[0] == 's') return LRAction::shift(std::stoi(action.substr(1)));
+        if (action[0] == 'r') return LRAction::reduce(std::stoi(action.substr(1)));
+        return LRAction::ERROR;
+    }
+}
+
+void SyntaxAnalyzer::setAction(int state, const Symbol& symbol, const std::string& action) {
+    auto [it, inserted] = actionTable.emplace(std::make_pair(state, symbol), action);
+    if (inserted || it->second == action) return;
+
+    // 同一个表项出现两个不同的动作：记录冲突，按固定的优先级保留一个
+    std::string chosen = preferAction(action, it->second) ? action : it->second;
+    conflicts.push_back({state, symbol, it->second, action, chosen});
+    it->second = chosen;
+}
+
 void SyntaxAnalyzer::constructParsingTables() {
-    std::cout << "=== 启动LR(1)分析器 ===";
-    // 首先构建LR(1)自动机，这会同时构建action和goto表
-    buildLR1Automaton();
-    // 检查并处理冲突
+    conflicts.clear();
+    // 冲突报告内部构造的对照分析器不输出提示和冲突，以免混进报告中
+    std::ostringstream discarded;
+    std::ostream& out = reportConstruction ? std::cout : discarded;
+    if (constructionMode == LALR1) {
+        out << "=== 启动LALR(1)分析器 ===";
+        // 先构造LR(0)项目集规范族，再计算向前看符号
+        buildLALR1Automaton();
+    } else if (constructionMode == MINIMAL_LR1) {
+        out << "=== 启动最小LR(1)分析器 ===";
+        // 构造LR(1)项目集的同时合并弱相容的同心状态
+        buildMinimalLR1Automaton();
+    } else {
+        out << "=== 启动LR(1)分析器 ===";
+        // 首先构建LR(1)自动机，这会同时构建action和goto表
+        if (buildThreads > 1) buildLR1AutomatonParallel();
+        else buildLR1Automaton();
+    }
+
+    // 输出构造过程中记录的冲突，默认采用移入优先策略；提示行没有换行，冲突另起一行
+    if (!conflicts.empty()) out << "\n";
+    for (const auto& conflict : conflicts) {
+        bool isShiftReduce = conflict.first[0] == 's' || conflict.second[0] == 's';
+        out << (isShiftReduce ? "Shift-reduce" : "Reduce-reduce")
+            << " conflict in state " << conflict.state
+            << " on symbol " << symbols.name(conflict.symbol)
+            << " (" << conflict.first << "/" << conflict.second
+            << ", resolved as " << conflict.chosen << ")" << std::endl;
+    }
+
+    compileParseTable();
+}
+
+void SyntaxAnalyzer::printConflictReport() {
+    static const char* modeNames[] = {"LR(1)", "LALR(1)", "最小LR(1)"};
+    std::cout << "\n=== 分析表冲突报告 ===\n";
+    std::cout << "构造方式: " << modeNames[constructionMode]
+              << ", 状态数: " << states.size() << ", 冲突数: " << conflicts.size() << "\n";
+    if (constructionMode == CANONICAL_LR1) {
+        for (const auto& conflict : conflicts) {
+            std::cout << "  I" << conflict.state << " on " << symbols.name(conflict.symbol) << ": "
+                      << conflict.first << "/" << conflict.second << "\n";
+        }
+        return;
+    }
+
+    // 用同一文法构造规范LR(1)分析表作为对照
+    SyntaxAnalyzer canonical;
+    canonical.setConstructionMode(CANONICAL_LR1);
+    canonical.reportConstruction = false;
+    canonical.loadGrammar(grammarFile);
+
+    // 项目集的核心：去掉向前看符号后的核心项目
+    auto coreOf = [](const std::set<LR1Item>& items) {
+        std::set<std::pair<int, size_t>> core;
+        for (const auto& item : items) {
+            if (item.dotPosition > 0 || item.prod.index == 0) core.insert({item.prod.index, item.dotPosition});
+        }
+        return core;
+    };
+
+    // 规范LR(1)中已有的冲突，按状态核心归类；合并后的状态与同心的规范状态对应
+    std::set<std::pair<std::set<std::pair<int, size_t>>, Symbol>> inherited;
+    for (const auto& conflict : canonical.conflicts) {
+        inherited.insert({coreOf(canonical.states.at(conflict.state)), conflict.symbol});
+    }
+
+    std::cout << "规范LR(1)对照: 状态数: " << canonical.states.size()
+              << ", 冲突数: " << canonical.conflicts.size() << "\n";
+    size_t introduced = 0;
+    for (const auto& conflict : conflicts) {
+        bool isNew = inherited.count({coreOf(states.at(conflict.state)), conflict.symbol}) == 0;
+        if (isNew) introduced++;
+        std::cout << "  I" << conflict.state << " on " << symbols.name(conflict.symbol) << ": "
+                  << conflict.first << "/" << conflict.second
+                  << (isNew ? "  [合并同心状态引入]" : "  [规范LR(1)中已存在]") << "\n";
+    }
+    std::cout << modeNames[constructionMode] << "引入的新冲突: " << introduced << "\n";
+}
+
+void SyntaxAnalyzer::compileParseTable() {
+    parseTable = ParseTable();
+    nonTerminalIds.clear();
+
+    // 终结符沿用indexProductions中的编号，终结符之后是结束符号#
+    for (const auto& terminal : terminalSymbols) {
+        if (terminal.type() == END_MARKER) parseTable.endMarker = parseTable.terminalCount;
+        parseTable.addName(symbols.name(terminal));
+        parseTable.terminalCount++;
+    }
+    // 非终结符包括只出现在右部的符号，按句柄顺序（即名称顺序）编号
+    for (uint32_t index = 0; index < symbols.count(NON_TERMINAL); index++) {
+        Symbol nonTerminal(NON_TERMINAL, index);
+        nonTerminalIds[nonTerminal] = parseTable.nonTerminalCount;
+        parseTable.addName(symbols.name(nonTerminal));
+        parseTable.nonTerminalCount++;
+    }
+
+    std::vector<int32_t> right;
+    for (const auto& prod : productions) {
+        right.clear();
+        for (const auto& symbol : prod.right) {
+            right.push_back(symbol.type() == NON_TERMINAL ? parseTable.terminalCount + nonTerminalIds.at(symbol)
+                                                          : terminalIds.at(symbol));
+        }
+        parseTable.addProduction(nonTerminalIds.at(prod.left), right);
+    }
+
+    if (!tokenBindings.empty()) {
+        parseTable.tokenBindings.assign(TOKEN_TYPE_COUNT, -1);
+        for (const auto& [type, terminal] : tokenBindings) parseTable.tokenBindings[type] = terminalIds.at(terminal);
+    }
+
+    parseTable.stateCount = static_cast<int>(states.size());
+    parseTable.action.assign(static_cast<size_t>(parseTable.stateCount) * parseTable.terminalCount, LRAction::ERROR);
+    parseTable.goTo.assign(static_cast<size_t>(parseTable.stateCount) * parseTable.nonTerminalCount, -1);
+
+    // 文本形式的动作只在这里解析一次
     for (const auto& [stateSymbol, action] : actionTable) {
-        int state = stateSymbol.first;
-        Symbol symbol = stateSymbol.second;
-
-        // 检查是否存在移入-规约冲突或规约-规约冲突
-        if (action[0] == 's') {  // 移入动作
-            for (const auto& [otherStateSymbol, otherAction] : actionTable) {
-                if (otherStateSymbol.first == state &&
-                    otherStateSymbol.second == symbol &&
-                    otherAction[0] == 'r') {
-                    // 这里可以实现冲突解决策略
-                    // 默认采用移入优先策略
-                    std::cout << "Shift-reduce conflict in state " << state
-                              << " on symbol " << symbol.name << std::endl;
-                }
-            }
+        size_t index = static_cast<size_t>(stateSymbol.first) * parseTable.terminalCount + terminalIds.at(stateSymbol.second);
+        parseTable.action[index] = actionCode(action);
+    }
+    // 冲突的表项在稠密表中只保留了优先的动作，GLR分析另外需要参与冲突的全部动作
+    multiActions.reset(parseTable.stateCount, parseTable.terminalCount);
+    for (const auto& conflict : conflicts) {
+        int terminal = terminalIds.at(conflict.symbol);
+        multiActions.add(conflict.state, terminal, actionCode(conflict.chosen));
+        multiActions.add(conflict.state, terminal, actionCode(conflict.first));
+        multiActions.add(conflict.state, terminal, actionCode(conflict.second));
+    }
+    for (const auto& [stateSymbol, target] : gotoTable) {
+        size_t index = static_cast<size_t>(stateSymbol.first) * parseTable.nonTerminalCount + nonTerminalIds.at(stateSymbol.second);
+        parseTable.goTo[index] = target;
+    }
+
+    // 新构造的分析表取代之前映射的分析表文件
+    mappedTable.close();
+    tableView = parseTable.view();
+    indexTerminalNames();
+    tree.clear();
+    forest.clear();
+    treeReusable = false;
+}
+
+void SyntaxAnalyzer::indexTerminalNames() {
+    // 终结符名 -> 编号的哈希表，#和error不是输入中可能出现的Token，不放进去
+    terminalByName.clear();
+    terminalByName.reserve(tableView.terminalCount);
+    errorTerminal = -1;
+    for (int terminal = 0; terminal < tableView.terminalCount; terminal++) {
+        if (terminal == tableView.endMarker) continue;
+        if (tableView.symbolName(terminal) == "error") {
+            errorTerminal = terminal;
+            continue;
         }
+        terminalByName.emplace(tableView.symbolName(terminal), terminal);
     }
 }
 
+int SyntaxAnalyzer::classifyToken(const TokenInfo& token) const {
+    // 先按名称匹配（关键字、运算符以及直接写出的终结符），再按词法分析给出的Token类型匹配
+    auto found = terminalByName.find(std::string_view(token.value));
+    if (found != terminalByName.end()) return found->second;
+    return tableView.boundTerminal(token.type);
+}
+
+bool SyntaxAnalyzer::saveParseTable(const std::string& filename) const {
+    if (tableView.stateCount == 0) {
+        std::cerr << "Error: No parse table to save" << std::endl;
+        return false;
+    }
+    if (mappedTable.isOpen()) {
+        // 要保存的正是映射的文件时不必重写；保存到别处时原样复制映射的内容，此时parseTable是空的
+        std::error_code ec;
+        if (std::filesystem::equivalent(filename, mappedTable.path(), ec)) return true;
+        return mappedTable.saveAs(filename);
+    }
+    return ParseTableFile::write(filename, parseTable, grammarHash);
+}
+
+bool SyntaxAnalyzer::loadParseTable(const std::string& filename, const std::string& grammarFilename) {
+    // 只计算文法文本的哈希，不读取文法；文件不存在、已过期或不完整时返回false，由调用者改用loadGrammar
+    uint64_t hash;
+    if (!hashGrammarFile(grammarFilename, hash)) return false;
+    if (!mappedTable.open(filename, hash)) return false;
+    grammarFile = grammarFilename;
+    grammarHash = hash;
+    tableView = mappedTable.view();
+    indexTerminalNames();
+    tree.clear();
+    multiActions.clear();
+    forest.clear();
+    treeReusable = false;
+    return true;
+}
+
+bool SyntaxAnalyzer::hashGrammarFile(const std::string& filename, uint64_t& hash) const {
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open()) return false;
+    std::string text((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    hash = ParseTableFile::grammarHash(text, constructionMode);
+    return true;
+}
+
 bool SyntaxAnalyzer::analyze(const std::vector<TokenInfo>& tokens) {
-    // 打印输入字符串的token序列分析
-    std::cout << "\n=== Token合法性检查 ===\n";
-    std::cout << "Token序列: ";
-    for (const auto& token : tokens) {
-        std::cout << token.value << " ";
+    return analyze(tokens, ReductionHooks());
+}
+
+bool SyntaxAnalyzer::analyze(const std::vector<TokenInfo>& tokens, const ReductionHooks& hooks) {
+    bool full = traceLevel == TRACE_FULL;
+    if (full) {
+        // 打印输入字符串的token序列分析
+        std::cout << "\n=== Token合法性检查 ===\n";
+        std::cout << "Token序列: ";
+        for (const auto& token : tokens) {
+            std::cout << token.value << " ";
+        }
+        std::cout << "\n";
     }
-    std::cout << "\n";
 
-    // 检查每个token是否在文法的终结符集合中
+    // 检查每个token是否在终结符集合中，同时换算为终结符编号；只有完整跟踪时才逐个报告
     bool allTokensValid = true;
+    traceInput.clear();
+    traceEvents.clear();
+    traceInput.reserve(tokens.size() + 1);
     for (const auto& token : tokens) {
-        Symbol symbol(token.value, TERMINAL);
-        bool isValid = false;
+        int terminal = classifyToken(token);
+        bool isValid = terminal >= 0;
+        if (isValid) traceInput.push_back(terminal);
+        else allTokensValid = false;
+
+        if (full) {
+            std::cout << "Token '" << token.value << "' - ";
+            std::cout << (isValid ? "有效\n" : "无效 (不在文法的终结符集合中)\n");
+        } else if (!isValid) {
+            std::cout << "Token '" << token.value << "' (line " << token.lineNumber << ") - 无效 (不在文法的终结符集合中)\n";
+        }
+    }
 
-        // 检查token是否在终结符集合中
-        for (const auto& terminal : terminals) {
-            if (terminal.name == token.value) {
-                isValid = true;
+    if (!allTokensValid) {
+        std::cout << "\n错误：输入序列包含不在文法中的终结符\n";
+        return false;
+    }
+
+    if (full) std::cout << "\n结论：输入序列在词法上是合法的\n";
+
+    // 输入串已在检查时换算为终结符编号，分析过程中不再查找符号或比较字符串
+    // 分析表可能来自刚构造的ParseTable，也可能直接位于映射的分析表文件中
+    const ParseTableView& table = tableView;
+    const std::vector<int>& inputSymbols = traceInput;
+    traceInput.push_back(table.endMarker);
+
+    // 分析循环只维护状态栈，不做任何格式化；需要跟踪时每步追加一条紧凑的事件记录
+    bool recording = traceLevel != TRACE_NONE;
+    std::vector<int> stateStack = {0};
+    size_t inputPos = 0;
+    bool analysisSuccess = false;
+
+    // 构造语法树时另有一个与状态栈等高的结点栈（不含状态0），规约时栈顶的一段就是新结点的子结点
+    std::vector<uint32_t> nodeStack;
+    tree.clear();
+    if (buildTree) tree.reserve(tokens.size());
+    // 语义动作的值栈由hooks的持有者维护，与状态栈同步压入和弹出
+    bool semantic = hooks.shift != nullptr && hooks.reduce != nullptr;
+    if (semantic && hooks.begin) hooks.begin(hooks.context, tokens.size());
+
+    // 错误恢复的状态：同步Token的标记，以及恢复后还要成功移进几个Token才重新报告错误
+    errors.clear();
+    std::vector<char> isSyncToken;
+    if (maxErrors > 1) {
+        isSyncToken.assign(table.terminalCount, 0);
+        isSyncToken[table.endMarker] = 1;
+        for (const auto& name : syncTokenNames) {
+            auto found = terminalByName.find(std::string_view(name));
+            if (found != terminalByName.end()) isSyncToken[found->second] = 1;
+        }
+    }
+    constexpr int RECOVERY_SHIFTS = 3;
+    int recovering = 0;
+    bool errorLimitReached = false;
+
+    bool treeComplete = true;  // 按同步Token恢复时会丢掉部分输入，不再给出语法树
+
+    // 弹出栈顶count个符号，语法树结点和语义值随之弹出；返回弹出的子树覆盖的Token数
+    auto popSymbols = [&](size_t count) -> uint32_t {
+        uint32_t popped = 0;
+        stateStack.resize(stateStack.size() - count);
+        if (buildTree) {
+            for (size_t k = nodeStack.size() - count; k < nodeStack.size(); k++) popped += tree.node(nodeStack[k]).tokenCount;
+            nodeStack.resize(nodeStack.size() - count);
+        }
+        if (semantic && hooks.discard) hooks.discard(hooks.context, static_cast<int>(count));
+        return popped;
+    };
+    // 从栈顶向下找第一个在terminal上有动作的状态，返回需要弹出的符号个数，找不到时返回-1
+    auto depthAccepting = [&](int terminal, bool shiftOnly) -> long {
+        for (size_t depth = 0; depth < stateStack.size(); depth++) {
+            int32_t candidate = table.actionAt(stateStack[stateStack.size() - 1 - depth], terminal);
+            if (shiftOnly ? LRAction::isShift(candidate) : candidate != LRAction::ERROR) return static_cast<long>(depth);
+        }
+        return -1;
+    };
+    // 龙书的恐慌模式：在栈中找一个状态s和非终结符A，使GOTO(s, A)能处理terminal，
+    // 弹栈到s并压入A，当作A已经分析完毕；A的语法树结点和语义值只是占位
+    auto resumeAfterNonTerminal = [&](int terminal) -> bool {
+        for (size_t depth = 0; depth < stateStack.size(); depth++) {
+            int state = stateStack[stateStack.size() - 1 - depth];
+            for (int nonTerminal = 0; nonTerminal < table.nonTerminalCount; nonTerminal++) {
+                int target = table.gotoAt(state, nonTerminal);
+                if (target < 0 || table.actionAt(target, terminal) == LRAction::ERROR) continue;
+                popSymbols(depth);
+                stateStack.push_back(target);
+                if (buildTree) nodeStack.push_back(tree.addLeaf(table.terminalCount + nonTerminal, state, 0));
+                if (semantic && hooks.shiftError) hooks.shiftError(hooks.context);
+                return true;
+            }
+        }
+        return false;
+    };
+    // 恐慌模式：优先弹栈到能移进error的状态并移进error；没有这样的状态时跳过输入直到同步Token，
+    // 再弹栈到能处理该Token的状态。栈中没有状态能处理它时（例如只出现在语句内部的结束符;），
+    // 把同步Token也丢弃，按resumeAfterNonTerminal从下一个Token继续。
+    // 恢复后的前几个Token上再出错时只丢弃Token，不重新报告
+    auto recover = [&]() -> bool {
+        if (recovering == RECOVERY_SHIFTS) {
+            if (inputSymbols[inputPos] == table.endMarker) return false;
+            if (buildTree && !nodeStack.empty()) tree.extendTokens(nodeStack.back(), 1);
+            inputPos++;
+            return true;
+        }
+        recovering = RECOVERY_SHIFTS;
+        long depth = errorTerminal >= 0 ? depthAccepting(errorTerminal, true) : -1;
+        if (depth >= 0) {
+            // error的叶子覆盖被弹出的那些子树的Token
+            uint32_t popped = popSymbols(static_cast<size_t>(depth));
+            int errorState = stateStack.back();
+            stateStack.push_back(LRAction::shiftTarget(table.actionAt(errorState, errorTerminal)));
+            if (buildTree) nodeStack.push_back(tree.addLeaf(errorTerminal, errorState, popped));
+            if (semantic && hooks.shiftError) hooks.shiftError(hooks.context);
+            return true;
+        }
+        treeComplete = false;
+        while (true) {
+            int terminal = inputSymbols[inputPos];
+            if (!isSyncToken[terminal]) {
+                inputPos++;
+                continue;
+            }
+            depth = depthAccepting(terminal, false);
+            if (depth >= 0) {
+                popSymbols(static_cast<size_t>(depth));
+                return true;
+            }
+            if (terminal != table.endMarker) inputPos++;
+            if (resumeAfterNonTerminal(inputSymbols[inputPos])) return true;
+            if (terminal == table.endMarker) return false;
+        }
+    };
+
+    while (true) {
+        int currentState = stateStack.back();
+        int32_t action = table.actionAt(currentState, inputSymbols[inputPos]);
+        if (recording) traceEvents.push_back({action, static_cast<uint32_t>(inputPos)});
+
+        if (action == LRAction::ERROR) {
+            if (recovering == 0) {
+                int line = tokens.empty() ? 0 : tokens[std::min(inputPos, tokens.size() - 1)].lineNumber;
+                errors.push_back({currentState, inputSymbols[inputPos], inputPos, line});
+                // 完整跟踪时第一个错误由printTrace打印，其余错误在它之后统一打印，保持输入中的顺序
+                if (!full) printSyntaxError(errors.back());
+            }
+            if (errors.size() >= maxErrors) {
+                errorLimitReached = maxErrors > 1;
+                break;
+            }
+            if (!recover()) break;
+            continue;
+        }
+        if (LRAction::isShift(action)) {
+            stateStack.push_back(LRAction::shiftTarget(action));
+            if (buildTree) nodeStack.push_back(tree.addLeaf(inputSymbols[inputPos], currentState));
+            if (semantic) hooks.shift(hooks.context, static_cast<uint32_t>(inputPos));
+            inputPos++;
+            if (recovering > 0) recovering--;
+        } else if (LRAction::isReduce(action)) {
+            int prodIndex = LRAction::reduceProduction(action);
+            int left = table.productionLeft[prodIndex];
+            int length = table.productionLength[prodIndex];
+            if (buildTree) {
+                std::span<const uint32_t> childNodes(nodeStack.data() + nodeStack.size() - length, length);
+                int state = stateStack[stateStack.size() - 1 - length];
+                uint32_t node = tree.addNode(table.terminalCount + left, prodIndex, state, childNodes);
+                nodeStack.resize(nodeStack.size() - length);
+                nodeStack.push_back(node);
+            }
+            if (semantic) hooks.reduce(hooks.context, prodIndex, length);
+            stateStack.resize(stateStack.size() - length);
+            int target = table.gotoAt(stateStack.back(), left);
+            if (target < 0) {
+                if (!full) printGotoError(stateStack.back(), left);
                 break;
             }
+            stateStack.push_back(target);
+        } else {
+            // 经过错误恢复后到达的接受不算分析成功，但语法树和语义值仍然完整
+            analysisSuccess = errors.empty();
+            // 接受时栈中只剩开始符号的结点，不再为增广产生式建立结点
+            if (buildTree && treeComplete) tree.setRoot(nodeStack.back());
+            break;
+        }
+    }
+    treeReusable = buildTree && analysisSuccess;
+
+    if (errorLimitReached && !full) std::cout << "语法错误达到上限" << maxErrors << "个，停止分析\n";
+    if (traceLevel == TRACE_SUMMARY) {
+        std::cout << "分析" << (analysisSuccess ? "成功" : "失败") << ": " << tokens.size() << "个Token, "
+                  << traceEvents.size() << "步";
+        if (!errors.empty()) std::cout << ", " << errors.size() << "个语法错误";
+        std::cout << "\n";
+    }
+
+    if (full) {
+        // 打印原有的分析信息；从分析表文件加载时没有文法的中间结果可以打印
+        bool fromTableFile = mappedTable.isOpen();
+        if (!fromTableFile) printTokensAndFirstSets();
+        printTrace();
+        for (size_t i = 1; i < errors.size(); i++) printSyntaxError(errors[i]);
+        if (errorLimitReached) std::cout << "语法错误达到上限" << maxErrors << "个，停止分析\n";
+        if (analysisSuccess && !fromTableFile) {
+            printLR1Table();
+            printItemSets();
+        }
+    }
+    return analysisSuccess;
+}
+
+bool SyntaxAnalyzer::analyzeWithTree(const std::vector<TokenInfo>& tokens) {
+    bool previous = buildTree;
+    buildTree = true;
+    bool success = analyze(tokens);
+    buildTree = previous;
+    return success;
+}
+
+bool SyntaxAnalyzer::reparse(const std::vector<TokenInfo>& tokens, const TokenEdit& edit) {
+    /*
+     * 按Wagner-Graham的思路，把上次的语法树当作输入流：从左到右依次取出旧树中的子树，
+     * 与编辑区域不相交的子树作为一个整体，编辑区域内的旧Token丢弃，换成新插入的Token。
+     * 子树的根记录了压入它之前的LR状态，当前栈顶状态与之相同时，这棵子树的分析过程必然与上次完全相同，
+     * 于是直接按GOTO移进整棵子树；状态不同时把它拆成子结点继续尝试。
+     * 一棵子树的规约还依赖它后面的那个Token，所以编辑点左侧只复用结束位置在编辑点之前的子树，
+     * 编辑点右侧的子树后面仍是原来的Token，都可以复用。
+     */
+    size_t oldCount = traceInput.empty() ? 0 : traceInput.size() - 1;
+    size_t removedEnd = edit.start + edit.removed;
+    bool consistent = removedEnd <= oldCount && tokens.size() + edit.removed == oldCount + edit.inserted;
+    // 旧树中不再使用的结点留在同一块存储中，积累过多时完整分析一次，顺便清空存储
+    if (!treeReusable || tree.empty() || !consistent || tree.size() > 8 * (tokens.size() + 1)) {
+        return analyzeWithTree(tokens);
+    }
+
+    std::vector<int> insertedSymbols;
+    insertedSymbols.reserve(edit.inserted);
+    for (size_t k = 0; k < edit.inserted; k++) {
+        int terminal = classifyToken(tokens[edit.start + k]);
+        if (terminal < 0) return analyzeWithTree(tokens);  // 由完整分析报告非法的Token
+        insertedSymbols.push_back(terminal);
+    }
+
+    const ParseTableView& table = tableView;
+    struct Pending {
+        uint32_t node;
+        size_t oldStart;  // 子树在旧输入中的起始位置
+    };
+    struct Item {
+        uint32_t node;    // 旧树中的结点；新插入的Token为NO_NODE
+        int terminal;     // 终结符或者子树中第一个Token的终结符
+        size_t oldStart;
+        bool subtree;
+    };
+    std::vector<Pending> pending = {{tree.root(), 0}};
+    size_t insertedPos = 0;
+
+    auto pushChildren = [&](uint32_t node, size_t oldStart) {
+        std::span<const uint32_t> childNodes = tree.childrenOf(node);
+        size_t base = pending.size();
+        for (uint32_t child : childNodes) {
+            pending.push_back({child, oldStart});
+            oldStart += tree.node(child).tokenCount;
+        }
+        std::reverse(pending.begin() + static_cast<std::ptrdiff_t>(base), pending.end());
+    };
+    auto firstTerminal = [&](uint32_t node) {
+        while (!tree.node(node).isLeaf()) {
+            for (uint32_t child : tree.childrenOf(node)) {
+                if (tree.node(child).tokenCount > 0) {
+                    node = child;
+                    break;
+                }
+            }
+        }
+        return tree.node(node).symbol;
+    };
+    // 取输入流中的下一项，输入结束时返回false
+    auto nextItem = [&](Item& item) -> bool {
+        while (!pending.empty()) {
+            auto [node, oldStart] = pending.back();
+            const ParseTreeNode& current = tree.node(node);
+            // 新插入的Token排在编辑点之后的全部旧内容之前
+            if (oldStart >= edit.start && insertedPos < insertedSymbols.size()) break;
+            pending.pop_back();
+            size_t oldEnd = oldStart + current.tokenCount;
+            if (current.tokenCount == 0) continue;  // 空产生式的结点由分析重新得到
+            if (current.isLeaf()) {
+                if (oldStart >= edit.start && oldStart < removedEnd) continue;
+                item = {node, current.symbol, oldStart, false};
+                return true;
+            }
+            if (oldEnd < edit.start || oldStart >= removedEnd) {
+                item = {node, firstTerminal(node), oldStart, true};
+                return true;
+            }
+            pushChildren(node, oldStart);
+        }
+        if (insertedPos < insertedSymbols.size()) {
+            item = {ParseTree::NO_NODE, insertedSymbols[insertedPos++], 0, false};
+            return true;
         }
+        return false;
+    };
 
-        std::cout << "Token '" << token.value << "' - ";
-        if (isValid) {
-            std::cout << "有效\n";
+    std::vector<int> stateStack = {0};
+    std::vector<uint32_t> nodeStack;
+    Item item{};
+    bool hasItem = nextItem(item);
+    size_t steps = 0, reused = 0;
+    bool accepted = false;
+    while (true) {
+        steps++;
+        int currentState = stateStack.back();
+        if (hasItem && item.subtree && tree.node(item.node).state == currentState) {
+            // 状态相同，整棵子树一步移进
+            const ParseTreeNode& subtree = tree.node(item.node);
+            int target = table.gotoAt(currentState, subtree.symbol - table.terminalCount);
+            if (target < 0) return analyzeWithTree(tokens);
+            stateStack.push_back(target);
+            nodeStack.push_back(item.node);
+            reused++;
+            hasItem = nextItem(item);
+            continue;
+        }
+
+        int lookahead = hasItem ? item.terminal : table.endMarker;
+        int32_t action = table.actionAt(currentState, lookahead);
+        if (action == LRAction::ERROR) return analyzeWithTree(tokens);  // 编辑引入了语法错误，由完整分析报告
+        if (LRAction::isShift(action)) {
+            if (item.subtree) {
+                pushChildren(item.node, item.oldStart);
+                hasItem = nextItem(item);
+                continue;
+            }
+            bool sameLeaf = item.node != ParseTree::NO_NODE && tree.node(item.node).state == currentState;
+            nodeStack.push_back(sameLeaf ? item.node : tree.addLeaf(lookahead, currentState));
+            stateStack.push_back(LRAction::shiftTarget(action));
+            hasItem = nextItem(item);
+        } else if (LRAction::isReduce(action)) {
+            int prodIndex = LRAction::reduceProduction(action);
+            int left = table.productionLeft[prodIndex];
+            int length = table.productionLength[prodIndex];
+            std::span<const uint32_t> childNodes(nodeStack.data() + nodeStack.size() - length, length);
+            uint32_t node = tree.addNode(table.terminalCount + left, prodIndex,
+                                         stateStack[stateStack.size() - 1 - length], childNodes);
+            nodeStack.resize(nodeStack.size() - length);
+            nodeStack.push_back(node);
+            stateStack.resize(stateStack.size() - length);
+            int target = table.gotoAt(stateStack.back(), left);
+            if (target < 0) return analyzeWithTree(tokens);
+            stateStack.push_back(target);
         } else {
-            std::cout << "无效 (不在文法的终结符集合中)\n";
-            allTokensValid = false;
+            accepted = !hasItem;
+            break;
         }
     }
+    if (!accepted) return analyzeWithTree(tokens);
+
+    tree.setRoot(nodeStack.back());
+    traceInput.erase(traceInput.begin() + static_cast<std::ptrdiff_t>(edit.start),
+                     traceInput.begin() + static_cast<std::ptrdiff_t>(removedEnd));
+    traceInput.insert(traceInput.begin() + static_cast<std::ptrdiff_t>(edit.start),
+                      insertedSymbols.begin(), insertedSymbols.end());
+    traceEvents.clear();
+    errors.clear();
+    if (traceLevel != TRACE_NONE) {
+        std::cout << "增量分析成功: " << tokens.size() << "个Token, " << steps << "步, 复用" << reused << "棵子树\n";
+    }
+    return true;
+}
+
+void SyntaxAnalyzer::printParseTree(const std::vector<TokenInfo>& tokens) const {
+    if (tree.empty()) {
+        std::cout << "没有可打印的语法树\n";
+        return;
+    }
+    std::vector<std::string> values;
+    values.reserve(tokens.size());
+    for (const auto& token : tokens) values.push_back(token.value);
+    std::cout << "\n=== 语法树 ===\n";
+    tree.print(std::cout, tableView, values);
+}
 
+bool SyntaxAnalyzer::analyzeGLR(const std::vector<TokenInfo>& tokens) {
+    std::vector<int> input;
+    input.reserve(tokens.size() + 1);
+    bool allTokensValid = true;
+    for (const auto& token : tokens) {
+        int terminal = classifyToken(token);
+        if (terminal >= 0) {
+            input.push_back(terminal);
+        } else {
+            allTokensValid = false;
+            std::cout << "Token '" << token.value << "' (line " << token.lineNumber << ") - 无效 (不在文法的终结符集合中)\n";
+        }
+    }
+    forest.clear();
+    errors.clear();
     if (!allTokensValid) {
         std::cout << "\n错误：输入序列包含不在文法中的终结符\n";
         return false;
     }
+    input.push_back(tableView.endMarker);
+
+    GLRResult result = glrParser.parse(input, forest);
+    if (!result.accepted) {
+        // 所有分支都在同一个输入位置失败，报告其中一个栈顶的状态
+        size_t position = result.errorPosition;
+        int lineNumber = position < tokens.size() ? tokens[position].lineNumber : tokens.empty() ? 0 : tokens.back().lineNumber;
+        errors.push_back({result.errorState, input[position], position, lineNumber});
+        printSyntaxError(errors.back());
+        forest.clear();
+    }
 
-    std::cout << "\n结论：输入序列在词法上是合法的\n";
-
-    std::vector<int> stateStack = {0};
-    std::vector<Symbol> symbolStack;
-    std::vector<Symbol> inputSymbols;
+    if (traceLevel != TRACE_NONE) {
+        std::cout << "GLR分析" << (result.accepted ? "成功" : "失败") << ": " << tokens.size() << "个Token, "
+                  << multiActions.conflictCount() << "个冲突表项, 栈结点" << result.stackNodes << "个";
+        if (result.accepted) {
+            std::cout << ", 森林结点" << forest.size() << "个, 歧义结点" << forest.ambiguousNodeCount() << "个, ";
+            uint64_t derivations = forest.derivationCount();
+            if (derivations == UINT64_MAX) std::cout << "推导数超出范围";
+            else std::cout << derivations << "种推导";
+        }
+        std::cout << "\n";
+    }
+    return result.accepted;
+}
 
-    for (const auto& token : tokens) {
-        Symbol symbol(token.value, TERMINAL);
-        inputSymbols.push_back(symbol);
+void SyntaxAnalyzer::printParseForest(const std::vector<TokenInfo>& tokens) const {
+    if (forest.empty()) {
+        std::cout << "没有可打印的分析森林\n";
+        return;
     }
-    inputSymbols.push_back(Symbol("#", END_MARKER));
+    std::vector<std::string> values;
+    values.reserve(tokens.size());
+    for (const auto& token : tokens) values.push_back(token.value);
+    std::cout << "\n=== 分析森林 ===\n";
+    forest.print(std::cout, tableView, values);
+}
 
-    size_t inputPos = 0;
-    bool analysisSuccess = false;
-    int step = 1;
+void SyntaxAnalyzer::printSyntaxError(const SyntaxError& error) const {
+    std::cout << "Error: No action defined for state " << error.state
+              << " on symbol " << tableView.symbolName(error.terminal) << " (line " << error.lineNumber << ")" << std::endl;
+}
+
+void SyntaxAnalyzer::printActionError(int state, int terminal) const {
+    std::cout << "Error: No action defined for state " << state
+              << " on symbol " << tableView.symbolName(terminal) << std::endl;
+}
 
-    // 打印原有的分析信息
-    printTokensAndFirstSets();
+void SyntaxAnalyzer::printGotoError(int state, int nonTerminal) const {
+    std::cout << "Error: No goto defined for state " << state
+              << " on symbol " << tableView.nonTerminalName(nonTerminal) << std::endl;
+}
+
+void SyntaxAnalyzer::printTrace() const {
+    /*
+     * 按记录的动作重新执行一遍分析，重建每一步的状态栈、符号栈和剩余输入并打印。
+     * 每一行都要输出整个栈和剩余输入，格式化只在这里进行，分析循环本身不受影响。
+     */
+    const ParseTableView& table = tableView;
+    const std::vector<int>& inputSymbols = traceInput;
+
+    // 符号栈中终结符保存其编号，非终结符保存 终结符个数+编号，与视图中的统一符号编号一致
+    auto symbolName = [&table](int symbol) { return table.symbolName(symbol); };
 
     // 打印分析过程表头
     std::cout << "\n=== LR(1)字符串输入分析过程 ===\n";
     std::cout << "\n步骤  | 状态栈               | 符号栈               | 输入串               | 动作\n";
     std::cout << "----------------------------------------------------------------------------------------\n";
 
-    while (true) {
+    std::vector<int> stateStack = {0};
+    std::vector<int> symbolStack;
+    int step = 1;
+
+    for (const auto& event : traceEvents) {
         int currentState = stateStack.back();
-        Symbol currentSymbol = inputSymbols[inputPos];
+        size_t inputPos = event.inputPosition;
+        int currentSymbol = inputSymbols[inputPos];
+        int32_t action = event.action;
+
+        if (action == LRAction::ERROR) {
+            printActionError(currentState, currentSymbol);
+            return;
+        }
 
         // 构建状态栈字符串
         std::string stateStackStr;
@@ -559,8 +1496,9 @@ bool SyntaxAnalyzer::analyze(const std::vector<TokenInfo>& tokens) {
         std::string symbolStackStr="#";
         if (!symbolStack.empty()) {
             symbolStackStr += " "; // 如果符号栈不为空，在 # 后加一个空格
-            for (const auto& sym : symbolStack) {
-                symbolStackStr += sym.name + " ";
+            for (int sym : symbolStack) {
+                symbolStackStr += symbolName(sym);
+                symbolStackStr += " ";
             }
         } else {
             symbolStackStr += " "; // 如果符号栈为空，确保 # 后面有一个空格，显示为 "# "
@@ -569,74 +1507,52 @@ bool SyntaxAnalyzer::analyze(const std::vector<TokenInfo>& tokens) {
         // 构建剩余输入串
         std::string inputStr;
         for (size_t i = inputPos; i < inputSymbols.size(); i++) {
-            inputStr += inputSymbols[i].name;
+            inputStr += symbolName(inputSymbols[i]);
             if (i < inputSymbols.size() - 1) inputStr += " ";
         }
-        auto actionIt = actionTable.find({currentState, currentSymbol});
-        if (actionIt == actionTable.end()) {
-            std::cout << "Error: No action defined for state " << currentState
-                      << " on symbol " << currentSymbol.name << std::endl;
-            return false;
-        }
 
-        std::string action = actionIt->second;
         std::string actionStr;
 
-        if (action[0] == 's') {
-            int nextState = std::stoi(action.substr(1));
+        if (LRAction::isShift(action)) {
+            int nextState = LRAction::shiftTarget(action);
             actionStr = "移进s" + std::to_string(nextState);
             stateStack.push_back(nextState);
             symbolStack.push_back(currentSymbol);
-            inputPos++;
         }
-        else if (action[0] == 'r') {
-            int prodIndex = std::stoi(action.substr(1));
-            const Production& prod = productions[prodIndex];
-            actionStr = "规约r" + std::to_string(prodIndex) + "(" +
-                       prod.left.name + "->" +
-                       [&prod]() {
-                           std::string s;
-                           for (const auto& sym : prod.right) s += sym.name;
-                           return s;
-                       }() + ")";
-
-            for (size_t i = 0; i < prod.right.size(); i++) {
-                stateStack.pop_back();
-                symbolStack.pop_back();
+        else if (LRAction::isReduce(action)) {
+            int prodIndex = LRAction::reduceProduction(action);
+            int length = table.productionLength[prodIndex];
+            int left = table.productionLeft[prodIndex];
+            actionStr = "规约r" + std::to_string(prodIndex) + "(";
+            actionStr += table.nonTerminalName(left);
+            actionStr += "->";
+            for (uint32_t k = table.productionRightOffsets[prodIndex]; k < table.productionRightOffsets[prodIndex + 1]; k++) {
+                actionStr += symbolName(table.productionRight[k]);
             }
+            actionStr += ")";
 
-            symbolStack.push_back(prod.left);
+            stateStack.resize(stateStack.size() - length);
+            symbolStack.resize(symbolStack.size() - length);
+
+            symbolStack.push_back(table.terminalCount + left);
             int previousState = stateStack.back();
-            auto gotoIt = gotoTable.find({previousState, prod.left});
-            if (gotoIt == gotoTable.end()) {
-                std::cout << "Error: No goto defined for state " << previousState
-                          << " on symbol " << prod.left.name << std::endl;
-                return false;
+            int target = table.gotoAt(previousState, left);
+            if (target < 0) {
+                printGotoError(previousState, left);
+                return;
             }
-            stateStack.push_back(gotoIt->second);
+            stateStack.push_back(target);
         }
-        else if (action == "acc") {
+        else {
             printf("%2d   | %-20s| %-20s| %-20s| 接受\n",
                    step, stateStackStr.c_str(), symbolStackStr.c_str(), inputStr.c_str());
-            analysisSuccess = true;
-            break;
-        }
-        else {
-            std::cout << "Error: Invalid action " << action << std::endl;
-            return false;
+            return;
         }
 
         printf("%2d   | %-20s| %-20s| %-20s| %s\n",
                step, stateStackStr.c_str(), symbolStackStr.c_str(), inputStr.c_str(), actionStr.c_str());
         step++;
     }
-
-    if (analysisSuccess) {
-        printLR1Table();
-        printItemSets();
-        return true;
-    }
-    return false;
 }
 
 void SyntaxAnalyzer::outputResult(const std::string& filename) const {
@@ -650,7 +1566,7 @@ void SyntaxAnalyzer::outputResult(const std::string& filename) const {
     file << "Grammar Productions:\n";
     file << "-------------------\n";
     for (const auto& prod : productions) {
-        file << prod.index << ": " << prod.toString() << "\n";
+        file << prod.index << ": " << prod.toString(symbols) << "\n";
     }
     file << "\n";
 
@@ -658,11 +1574,8 @@ void SyntaxAnalyzer::outputResult(const std::string& filename) const {
     file << "First Sets:\n";
     file << "-----------\n";
     for (const auto& nonTerminal : nonTerminals) {
-        file << "FIRST(" << nonTerminal.name << ") = { ";
-        for (const auto& symbol : firstSets.at(nonTerminal)) {
-            file << symbol.name << " ";
-        }
-        file << "}\n";
+        file << "FIRST(" << symbols.name(nonTerminal) << ") = { "
+             << formatTerminalSet(firstSets[nonTerminal.index()], nullable[nonTerminal.index()]) << "}\n";
     }
     file << "\n";
 
@@ -670,21 +1583,18 @@ void SyntaxAnalyzer::outputResult(const std::string& filename) const {
     file << "Follow Sets:\n";
     file << "-----------\n";
     for (const auto& nonTerminal : nonTerminals) {
-        file << "FOLLOW(" << nonTerminal.name << ") = { ";
-        for (const auto& symbol : followSets.at(nonTerminal)) {
-            file << symbol.name << " ";
-        }
-        file << "}\n";
+        file << "FOLLOW(" << symbols.name(nonTerminal) << ") = { "
+             << formatTerminalSet(followSets[nonTerminal.index()], false) << "}\n";
     }
     file << "\n";
 
     // 4. 输出LR(1)项目集族
     file << "LR(1) Item Sets:\n";
     file << "---------------\n";
-    for (const auto& [stateId, itemSet] : states) {
+    for (const auto& [stateId, kernel] : states) {
         file << "State " << stateId << ":\n";
-        for (const auto& item : itemSet) {
-            file << "    " << item.toString() << "\n";
+        for (const auto& item : closure(kernel)) {
+            file << "    " << item.toString(symbols, terminalSymbols) << "\n";
         }
         file << "\n";
     }
@@ -695,18 +1605,15 @@ void SyntaxAnalyzer::printTokensAndFirstSets() const {
     // 1. 显示词法分析token令牌表
     std::cout << "\n=== 词法分析Token令牌表 ===\n";
     for (const auto& terminal : terminals) {
-        if (terminal.type == END_MARKER) continue;
-        std::cout << terminal.name << " ";
+        if (terminal.type() == END_MARKER) continue;
+        std::cout << symbols.name(terminal) << " ";
     }
 
     // 2. 显示First集
     std::cout << "\n=== 非终结符First集 ===\n";
     for (const auto& nonTerminal : nonTerminals) {
-        std::cout << "FIRST(" << nonTerminal.name << ") = { ";
-        for (const auto& symbol : firstSets.at(nonTerminal)) {
-            std::cout << symbol.name << " ";
-        }
-        std::cout << "}\n";
+        std::cout << "FIRST(" << symbols.name(nonTerminal) << ") = { "
+                  << formatTerminalSet(firstSets[nonTerminal.index()], nullable[nonTerminal.index()]) << "}\n";
     }
     std::cout << std::flush;
 }
@@ -717,14 +1624,14 @@ void SyntaxAnalyzer::printLR1Table() const {
     // 获取终结符和非终结符列表
     std::vector<Symbol> termList, nonTermList;
     for (const auto& term : terminals) {
-        if (term.type != END_MARKER) {
+        if (term.type() != END_MARKER) {
             termList.push_back(term);
         }
     }
-    termList.push_back(Symbol("#", END_MARKER));
+    termList.push_back(END_SYMBOL);
 
     for (const auto& nonTerm : nonTerminals) {
-        if (nonTerm.name != "S'") {
+        if (nonTerm != productions[0].left) {
             nonTermList.push_back(nonTerm);
         }
     }
@@ -733,11 +1640,11 @@ void SyntaxAnalyzer::printLR1Table() const {
     std::cout << "State\t";
     std::cout << "ACTION\t";
     for (const auto& term : termList) {
-        std::cout << term.name << "\t";
+        std::cout << symbols.name(term) << "\t";
     }
     std::cout << "GOTO\t";
     for (size_t i = 0; i < nonTermList.size(); ++i) {
-        std::cout << nonTermList[i].name;
+        std::cout << symbols.name(nonTermList[i]);
         if (i < nonTermList.size() - 1) {
             std::cout << "\t";
         }
@@ -749,34 +1656,11 @@ void SyntaxAnalyzer::printLR1Table() const {
     for (int state = 0; state <= maxState; ++state) {
         std::cout << state << "\t\t|\t\t";
 
-        // 检查该状态下是否有规约动作以及规约产生式
-        std::string reductionAction;
-        bool hasReduction = false;
-        for (const auto& term : termList) {
-            if (term.type != END_MARKER) {
-                auto it = actionTable.find({state, term});
-                if (it != actionTable.end() && it->second[0] == 'r') {
-                    reductionAction = it->second;
-                    hasReduction = true;
-                    break;
-                }
-            }
-        }
-
         // 打印ACTION部分
         for (const auto& term : termList) {
             auto it = actionTable.find({state, term});
             if (it != actionTable.end()) {
-                if (term.type == END_MARKER && it->second[0] == 'r' && hasReduction) {
-                    // 如果是#号且是规约动作，检查是否与其他终结符的规约相同
-                    if (it->second == reductionAction) {
-                        std::cout << "\t";  // 相同则不显示
-                    } else {
-                        std::cout << it->second << "\t";  // 不同则显示
-                    }
-                } else {
-                    std::cout << it->second << "\t";
-                }
+                std::cout << it->second << "\t";
             } else {
                 std::cout << "\t";
             }
@@ -800,16 +1684,16 @@ void SyntaxAnalyzer::printLR1Table() const {
 }
 void SyntaxAnalyzer::printItemSets() const {
     std::cout << "\n=== LR(1)项目集 ===\n";
-    for (const auto& [stateId, itemSet] : states) {
+    for (const auto& [stateId, kernel] : states) {
         std::cout << "\nI" << stateId << ":\n";
         std::cout << "----------------\n";
 
-        for (const auto& item : itemSet) {
-            std::cout << item.prod.left.name << " -> ";
+        for (const auto& item : closure(kernel)) {
+            std::cout << symbols.name(item.prod.left) << " -> ";
 
             // 打印点号之前的符号
             for (size_t i = 0; i < item.dotPosition; i++) {
-                std::cout << item.prod.right[i].name << " ";
+                std::cout << symbols.name(item.prod.right[i]) << " ";
             }
 
             // 打印点号
@@ -817,33 +1701,14 @@ void SyntaxAnalyzer::printItemSets() const {
 
             // 打印点号之后的符号
             for (size_t i = item.dotPosition; i < item.prod.right.size(); i++) {
-                std::cout << item.prod.right[i].name << " ";
+                std::cout << symbols.name(item.prod.right[i]) << " ";
             }
 
             // 处理向前看符号集合
             std::cout << ", { ";
-            bool hasOnlyEndMarker = true;
-            bool hasEndMarker = false;
-
-            // 首先检查向前看符号集合的内容
-            for (const auto& symbol : item.lookahead) {
-                if (symbol.type == END_MARKER) {
-                    hasEndMarker = true;
-                } else {
-                    hasOnlyEndMarker = false;
-                }
-            }
-
-            // 打印向前看符号
-            for (const auto& symbol : item.lookahead) {
-                if (symbol.type == END_MARKER) {
-                    if (hasOnlyEndMarker) {
-                        std::cout << symbol.name << " ";
-                    }
-                } else {
-                    std::cout << symbol.name << " ";
-                }
-            }
+            item.lookahead.forEach([this](int id) {
+                std::cout << symbols.name(terminalSymbols[id]) << " ";
+            });
             std::cout << "}\n";
         }
     }
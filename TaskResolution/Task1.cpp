@@ -4,8 +4,65 @@
 #include <vector>
 #include <string>
 #include <cctype>
+#include <algorithm>
 #include <LexicalAnalysis.h>
-int main() {
+#include <BatchLexer.h>
+
+// 批量模式：Task1 --batch <文法文件> [--jobs N] [--out-dir 目录] [--columnar 文件] <目录|@文件列表|源文件>...
+static int runBatch(int argc, char* argv[]) {
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0]
+                  << " --batch <grammar> [--jobs N] [--out-dir DIR] [--columnar FILE] <dir|@list|file>..."
+                  << std::endl;
+        return 1;
+    }
+
+    std::string grammar_file = argv[2];
+    BatchOptions options;
+    std::vector<std::string> inputs;
+    for (int i = 3; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--jobs" && i + 1 < argc) {
+            // 只接受非负整数，0表示使用硬件线程数；std::stoul会接受"-1"并在非数字时抛出异常，这里先检查每个字符
+            std::string value = argv[++i];
+            bool valid = !value.empty() && value.size() <= 4 &&
+                         std::all_of(value.begin(), value.end(), [](char c) { return c >= '0' && c <= '9'; });
+            if (!valid) {
+                std::cerr << "Error: --jobs needs a non-negative integer, got '" << value << "'" << std::endl;
+                return 1;
+            }
+            options.jobs = static_cast<unsigned>(std::stoul(value));
+        } else if (arg == "--out-dir" && i + 1 < argc) {
+            options.output_dir = argv[++i];
+        } else if (arg == "--columnar" && i + 1 < argc) {
+            options.columnar_file = argv[++i];
+        } else {
+            inputs.push_back(arg);
+        }
+    }
+    if (options.output_dir.empty() && options.columnar_file.empty()) {
+        std::cerr << "Either --out-dir or --columnar must be given" << std::endl;
+        return 1;
+    }
+
+    // 文法只编译一次，编译结果在所有工作线程间只读共享
+    LexicalAnalysis analyzer;
+    if (!analyzer.loadGrammar(grammar_file)) {
+        std::cerr << "Failed to load grammar" << std::endl;
+        return 1;
+    }
+    const CompiledLexer lexer = analyzer.lexer();
+
+    std::vector<BatchSource> sources = BatchLexer::collectSources(inputs);
+    BatchLexer batch(lexer, options);
+    return batch.run(sources) ? 0 : 1;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc > 1 && std::string(argv[1]) == "--batch") {
+        return runBatch(argc, argv);
+    }
+
     LexicalAnalysis analyzer;
 
     // 加载文法
@@ -20,8 +77,9 @@ int main() {
     // 分析源代码
     auto tokens = analyzer.analyze(source);
 
-    // 输出结果
-    analyzer.printTokens(tokens);
+    // 输出结果，行号在输出时由换行符偏移索引换算
+    LineIndex lines(source);
+    analyzer.printTokens(tokens, lines);
 
     return 0;
-}
\ No newline at end of file
+}
@@ -2,23 +2,94 @@
 #include "LexicalAnalyzer.h"
 #include <iostream>
 #include <fstream>
+#include <sstream>
 #include <vector>
 #include <string>
+#include <algorithm>
 #include <windows.h>
 
-int main() {
+int main(int argc, char* argv[]) {
     SetConsoleOutputCP(65001);
     // 1. 创建并初始化语法分析器
     SyntaxAnalyzer analyzer;
+    std::string grammarPath = "../TestCase/Task2Case/grammar_5.txt";
+    std::string inputPath = "../TestCase/Task2Case/input_5_1.txt";
+
+    // --table <文件>：优先映射已保存的分析表，文件不存在或与文法不符时照常构造并保存
+    // --trace none|summary|full：分析过程的输出详细程度，默认输出完整的分析过程
+    // --tree：分析成功后打印语法树
+    // --max-errors <n>：出错后继续分析，最多报告n个语法错误
+    // --sync <a,b,...>：错误恢复的同步Token，与--max-errors一起使用
+    // --grammar <文件> / --input <文件>：改用其他文法和输入，例如grammar_7.txt与input_7_1.txt演示一次报告多个错误
+    // --glr：用GLR方式分析，冲突的表项保留全部动作；与--tree一起使用时打印分析森林
+    std::string tablePath;
+    bool printTree = false;
+    bool useGLR = false;
+    analyzer.setTraceLevel(TRACE_FULL);
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--tree") {
+            printTree = true;
+            analyzer.setBuildTree(true);
+            continue;
+        }
+        if (arg == "--glr") {
+            useGLR = true;
+            continue;
+        }
+        // 其余选项都带一个参数，取出参数后跳过它，参数不会再被当作选项
+        if (arg != "--table" && arg != "--trace" && arg != "--max-errors" && arg != "--sync" &&
+            arg != "--grammar" && arg != "--input") {
+            std::cerr << "Error: Unknown option " << arg << std::endl;
+            return 1;
+        }
+        if (i + 1 >= argc) {
+            std::cerr << "Error: Missing value for " << arg << std::endl;
+            return 1;
+        }
+        std::string value = argv[++i];
+        if (arg == "--table") {
+            tablePath = value;
+        } else if (arg == "--grammar") {
+            grammarPath = value;
+        } else if (arg == "--input") {
+            inputPath = value;
+        } else if (arg == "--sync") {
+            std::vector<std::string> names;
+            std::stringstream list(value);
+            for (std::string name; std::getline(list, name, ',');) {
+                if (!name.empty()) names.push_back(name);
+            }
+            analyzer.setSyncTokens(names);
+        } else if (arg == "--trace") {
+            if (value != "none" && value != "summary" && value != "full") {
+                std::cerr << "Error: --trace needs none|summary|full" << std::endl;
+                return 1;
+            }
+            analyzer.setTraceLevel(value == "none" ? TRACE_NONE : value == "summary" ? TRACE_SUMMARY : TRACE_FULL);
+        } else {
+            // 只接受正整数；std::stoul会接受"-1"并在非数字时抛出异常，这里先检查每个字符
+            bool valid = !value.empty() && value.size() <= 9 &&
+                         std::all_of(value.begin(), value.end(), [](char c) { return c >= '0' && c <= '9'; });
+            if (!valid || std::stoul(value) == 0) {
+                std::cerr << "Error: --max-errors needs a positive integer, got '" << value << "'" << std::endl;
+                return 1;
+            }
+            analyzer.setMaxErrors(std::stoul(value));
+        }
+    }
 
     // 2. 加载文法规则
-    if (!analyzer.loadGrammar("../TestCase/Task2Case/grammar_5.txt")) {
-        std::cerr << "Failed to load grammar.txt file!" << std::endl;
-        return 1;
+    if (tablePath.empty() || !analyzer.loadParseTable(tablePath, grammarPath)) {
+        if (!analyzer.loadGrammar(grammarPath)) {
+            std::cerr << "Failed to load grammar.txt file!" << std::endl;
+            return 1;
+        }
+        if (!tablePath.empty()) analyzer.saveParseTable(tablePath);
     }
 
     // 3. 读取源代码文件并进行词法分析
-    std::ifstream source_file("../TestCase/Task2Case/input_5_1.txt");
+    std::ifstream source_file(inputPath);
     if (!source_file.is_open()) {
         std::cerr << "Error: Could not open source code file!" << std::endl;
         return 1;
@@ -42,9 +113,11 @@ int main() {
 
     // 4. 执行语法分析
     try {
-        bool success = analyzer.analyze(syntax_tokens);
+        bool success = useGLR ? analyzer.analyzeGLR(syntax_tokens) : analyzer.analyze(syntax_tokens);
         if (success) {
             std::cout << "Syntax analysis completed successfully!" << std::endl;
+            if (printTree && useGLR) analyzer.printParseForest(syntax_tokens);
+            else if (printTree) analyzer.printParseTree(syntax_tokens);
             analyzer.outputResult("..\\TestCase\\analysis1_result.txt");
         } else {
             std::cout <<"Syntax analysis failed due to invalid input or grammar violations!" << std::endl;
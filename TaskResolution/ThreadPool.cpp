@@ -0,0 +1,111 @@
+#include "ThreadPool.h"
+
+namespace {
+    // 当前线程所属的线程池及其队列下标，用于判断submit是否来自工作线程
+    thread_local const ThreadPool* current_pool = nullptr;
+    thread_local unsigned current_index = 0;
+}
+
+ThreadPool::ThreadPool(unsigned thread_count) {
+    if (thread_count == 0) thread_count = 1;
+    for (unsigned i = 0; i < thread_count; i++) {
+        queues.push_back(std::make_unique<WorkQueue>());
+    }
+    for (unsigned i = 0; i < thread_count; i++) {
+        workers.emplace_back(&ThreadPool::workerLoop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(state_mutex);
+        stopping = true;
+    }
+    work_available.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::submit(std::function<void()> task) {
+    unsigned target = (current_pool == this)
+        ? current_index
+        : next_queue.fetch_add(1, std::memory_order_relaxed) % queues.size();
+
+    pending.fetch_add(1, std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lock(queues[target]->mutex);
+        queues[target]->tasks.push_back(std::move(task));
+    }
+    {
+        std::lock_guard<std::mutex> lock(state_mutex);
+        ++queued;
+    }
+    work_available.notify_one();
+}
+
+void ThreadPool::wait() {
+    std::unique_lock<std::mutex> lock(state_mutex);
+    all_done.wait(lock, [this] { return pending.load() == 0; });
+    if (first_error) {
+        std::exception_ptr error = first_error;
+        first_error = nullptr;
+        std::rethrow_exception(error);
+    }
+}
+
+bool ThreadPool::takeTask(unsigned index, std::function<void()>& task) {
+    // 先从自己的队尾取
+    {
+        WorkQueue& own = *queues[index];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            return true;
+        }
+    }
+    // 再从其他队列的队首窃取
+    for (size_t k = 1; k < queues.size(); k++) {
+        WorkQueue& victim = *queues[(index + k) % queues.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::workerLoop(unsigned index) {
+    current_pool = this;
+    current_index = index;
+
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(state_mutex);
+            work_available.wait(lock, [this] { return stopping || queued > 0; });
+            if (queued == 0) return;  // stopping且已无任务
+            --queued;
+        }
+
+        // 已预留一个任务名额，它一定在某个队列中（可能正被其他线程窃取，重试即可）
+        std::function<void()> task;
+        while (!takeTask(index, task)) {
+            std::this_thread::yield();
+        }
+
+        try {
+            task();
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(state_mutex);
+            if (!first_error) first_error = std::current_exception();
+        }
+
+        if (pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            std::lock_guard<std::mutex> lock(state_mutex);
+            all_done.notify_all();
+        }
+    }
+}
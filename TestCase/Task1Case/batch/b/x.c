@@ -0,0 +1,2 @@
+float x = 3.5;
+x = x * 2;
@@ -0,0 +1,38 @@
+#ifndef SD2_BATCHLEXER_H
+#define SD2_BATCHLEXER_H
+
+#include "LexicalAnalysis.h"
+#include <string>
+#include <vector>
+
+// 批量词法分析的输出配置
+struct BatchOptions {
+    std::string output_dir;     // 非空时为每个源文件输出一个 <相对路径>.tokens 文件
+    std::string columnar_file;  // 非空时把所有Token按 文件/行/列/类型/值 五列写入同一个制表符分隔的流
+    unsigned jobs = 0;          // 工作线程数，0表示使用硬件线程数
+};
+
+// 待分析的源文件：实际路径和输出时使用的名字（目录扫描时为相对于该目录的路径，其余为给出的路径）
+struct BatchSource {
+    std::string path;
+    std::string name;
+};
+
+// 批量词法分析驱动：文法只编译一次，构建好的自动机以只读方式被所有工作线程共享，
+// 源文件以文件为单位分发到工作窃取线程池中并行分析
+class BatchLexer {
+public:
+    BatchLexer(const CompiledLexer& lexer, BatchOptions options);
+
+    // 展开输入参数：目录递归收集其中的普通文件，"@文件名"按行读取文件列表，其余视为单个源文件
+    static std::vector<BatchSource> collectSources(const std::vector<std::string>& inputs);
+
+    // 分析所有源文件，全部成功返回true；有两个源文件的输出名相同时不分析任何文件，直接返回false
+    bool run(const std::vector<BatchSource>& sources) const;
+
+private:
+    const CompiledLexer& lexer;
+    BatchOptions options;
+};
+
+#endif //SD2_BATCHLEXER_H
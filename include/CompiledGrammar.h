@@ -0,0 +1,480 @@
+#ifndef SD2_COMPILEDGRAMMAR_H
+#define SD2_COMPILEDGRAMMAR_H
+
+#include "LexicalAnalyzer.h"
+#include "ParseTable.h"
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+/*
+ * 编译期构造规范LR(1)分析表：文法以字符串字面量的形式写在源代码中，格式与loadGrammar读取的文件相同，
+ * First集、闭包、GOTO和填表全部在常量求值中完成，得到的数组是静态常量，运行时没有任何构造开销。
+ *
+ *     using Grammar = CompiledGrammar<"S -> B B\nB -> a B\nB -> b">;
+ *     const ParseTableView& table = Grammar::table;
+ *
+ * 符号编号、产生式编号、状态编号和冲突的处理都与SyntaxAnalyzer的规范LR(1)构造一致，
+ * 得到的分析表与loadGrammar构造的分析表逐项相同，%bind指令同样写入分析表。
+ * 常量求值的步数有限，适合直接写在源代码中的小型文法；状态较多（数百个）的文法
+ * 可能超出编译器默认的限制，需要调大-fconstexpr-ops-limit（GCC）或-fconstexpr-steps（Clang）。
+ */
+namespace ConstexprLR {
+    // 可以作为模板实参的字符串
+    template <size_t N>
+    struct FixedString {
+        char text[N]{};
+
+        constexpr FixedString(const char (&source)[N]) {
+            for (size_t i = 0; i < N; i++) text[i] = source[i];
+        }
+        constexpr std::string_view view() const { return {text, N - 1}; }
+    };
+
+    // 分析表各数组的长度，由第一遍构造求出，作为第二遍构造的模板实参
+    struct TableSizes {
+        bool valid = false;
+        int stateCount = 0;
+        int terminalCount = 0;
+        int nonTerminalCount = 0;
+        int productionCount = 0;
+        int rightCount = 0;     // 全部产生式右部的符号总数
+        int nameBytes = 0;      // 全部符号名的总长度
+        int conflictCount = 0;
+        int tokenBindingCount = 0;  // 有%bind指令时为TOKEN_TYPE_COUNT
+    };
+
+    namespace detail {
+        constexpr bool isSpace(char c) {
+            return c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\f' || c == '\r';
+        }
+
+        // 与loadGrammar相同：首字符为大写字母的是非终结符
+        constexpr bool isNonTerminalName(std::string_view name) {
+            return !name.empty() && name[0] >= 'A' && name[0] <= 'Z';
+        }
+
+        constexpr std::vector<std::string_view> splitWords(std::string_view line) {
+            std::vector<std::string_view> words;
+            size_t i = 0;
+            while (i < line.size()) {
+                while (i < line.size() && isSpace(line[i])) i++;
+                size_t start = i;
+                while (i < line.size() && !isSpace(line[i])) i++;
+                if (i > start) words.push_back(line.substr(start, i - start));
+            }
+            return words;
+        }
+
+        constexpr void sortUnique(std::vector<std::string_view>& names) {
+            std::sort(names.begin(), names.end());
+            names.erase(std::unique(names.begin(), names.end()), names.end());
+        }
+
+        constexpr int indexOf(const std::vector<std::string_view>& names, std::string_view name) {
+            auto it = std::lower_bound(names.begin(), names.end(), name);
+            return static_cast<int>(it - names.begin());
+        }
+
+        // 终结符集合的位图，字数W由文法的终结符个数决定，项目的复制和比较不需要动态分配
+        template <size_t W>
+        using Lookahead = std::array<uint64_t, W>;
+
+        template <size_t W>
+        struct Item {
+            int production = 0;
+            int dot = 0;
+            Lookahead<W> lookahead{};
+
+            constexpr bool operator==(const Item&) const = default;
+        };
+
+        template <size_t W>
+        constexpr bool mergeInto(Lookahead<W>& target, const Lookahead<W>& source) {
+            bool grew = false;
+            for (size_t w = 0; w < W; w++) {
+                grew |= (source[w] & ~target[w]) != 0;
+                target[w] |= source[w];
+            }
+            return grew;
+        }
+
+        // 读入的文法：符号统一编号，终结符 0 .. T-1（按名称排序，#在最后），非终结符n为 T+n
+        struct GrammarText {
+            std::vector<std::string_view> terminals;
+            std::vector<std::string_view> nonTerminals;
+            std::vector<int> left;
+            std::vector<int> rightStart = {0};
+            std::vector<int> right;
+            std::vector<std::vector<int>> productionsOf;  // 非终结符 -> 以它为左部的产生式
+            std::vector<int32_t> tokenBindings;           // %bind指令：Token类型 -> 终结符编号，没有指令时为空
+
+            constexpr int terminalCount() const { return static_cast<int>(terminals.size()); }
+            constexpr int nonTerminalCount() const { return static_cast<int>(nonTerminals.size()); }
+            constexpr int productionCount() const { return static_cast<int>(left.size()); }
+            constexpr int length(int production) const { return rightStart[production + 1] - rightStart[production]; }
+            constexpr int symbolAt(int production, int dot) const { return right[rightStart[production] + dot]; }
+
+            constexpr bool parse(std::string_view text) {
+                // 第一条产生式的第一个符号是原始文法的开始符号，%开头的指令行不算产生式
+                std::vector<std::string_view> lines;
+                for (size_t start = 0; start <= text.size();) {
+                    size_t end = text.find('\n', start);
+                    if (end == std::string_view::npos) end = text.size();
+                    lines.push_back(text.substr(start, end - start));
+                    start = end + 1;
+                }
+                size_t firstLine = 0;
+                while (firstLine < lines.size() && (lines[firstLine].empty() || lines[firstLine][0] == '%')) firstLine++;
+                if (firstLine == lines.size()) return false;
+                std::vector<std::string_view> firstWords = splitWords(lines[firstLine]);
+                if (firstWords.empty()) return false;
+                std::string_view startName = firstWords[0];
+
+                std::vector<std::vector<std::string_view>> grammarLines;
+                std::vector<std::vector<std::string_view>> bindLines;
+                nonTerminals = {"S'", startName};
+                for (auto line : lines) {
+                    if (line.empty() || line[0] == '#') continue;
+                    std::vector<std::string_view> words = splitWords(line);
+                    if (line[0] == '%') {
+                        // 与loadGrammar相同，未知的指令使文法无效
+                        if (words.size() < 3 || words[0] != "%bind") return false;
+                        bindLines.push_back(std::move(words));
+                        continue;
+                    }
+                    if (words.size() < 2 || words[1] != "->") continue;
+                    nonTerminals.push_back(words[0]);
+                    for (size_t k = 2; k < words.size(); k++) {
+                        (isNonTerminalName(words[k]) ? nonTerminals : terminals).push_back(words[k]);
+                    }
+                    grammarLines.push_back(std::move(words));
+                }
+                if (grammarLines.empty()) return false;
+                sortUnique(terminals);
+                sortUnique(nonTerminals);
+
+                // #排在全部终结符之后，不参与按名称的二分查找
+                int nameCount = static_cast<int>(terminals.size());
+                terminals.push_back("#");
+                auto code = [this, nameCount](std::string_view name) {
+                    if (isNonTerminalName(name)) return terminalCount() + indexOf(nonTerminals, name);
+                    return static_cast<int>(std::lower_bound(terminals.begin(), terminals.begin() + nameCount, name) -
+                                            terminals.begin());
+                };
+                // 0号为增广产生式 S' -> 开始符号
+                left.push_back(indexOf(nonTerminals, "S'"));
+                right.push_back(code(startName));
+                rightStart.push_back(static_cast<int>(right.size()));
+                for (const auto& words : grammarLines) {
+                    left.push_back(indexOf(nonTerminals, words[0]));
+                    for (size_t k = 2; k < words.size(); k++) right.push_back(code(words[k]));
+                    rightStart.push_back(static_cast<int>(right.size()));
+                }
+                productionsOf.resize(nonTerminals.size());
+                for (int p = 0; p < productionCount(); p++) productionsOf[left[p]].push_back(p);
+
+                // 未知的Token类型使文法无效；没有出现在产生式中的终结符与loadGrammar一样忽略这条绑定
+                if (!bindLines.empty()) tokenBindings.assign(TOKEN_TYPE_COUNT, -1);
+                for (const auto& words : bindLines) {
+                    auto type = std::find(std::begin(TOKEN_TYPE_NAMES), std::end(TOKEN_TYPE_NAMES), words[1]);
+                    if (type == std::end(TOKEN_TYPE_NAMES)) return false;
+                    int terminal = code(words[2]);
+                    if (isNonTerminalName(words[2]) || terminal == nameCount || terminals[terminal] != words[2]) continue;
+                    tokenBindings[type - std::begin(TOKEN_TYPE_NAMES)] = terminal;
+                }
+                return true;
+            }
+        };
+
+        template <size_t W>
+        struct Automaton : GrammarText {
+            using Item = detail::Item<W>;
+            bool valid = false;
+            std::vector<char> nullable;
+            std::vector<Lookahead<W>> firstSets;
+
+            std::vector<std::vector<Item>> kernels;
+            std::vector<uint64_t> kernelHashes;
+            std::vector<std::vector<size_t>> kernelBuckets = std::vector<std::vector<size_t>>(256);
+            std::vector<int32_t> action;
+            std::vector<int32_t> goTo;
+            int conflictCount = 0;
+
+            // 可空性与First集：对全部产生式反复迭代直到不再变化
+            constexpr void computeFirstSets() {
+                nullable.assign(nonTerminals.size(), 0);
+                firstSets.assign(nonTerminals.size(), Lookahead<W>{});
+                for (bool changed = true; changed;) {
+                    changed = false;
+                    for (int p = 0; p < productionCount(); p++) {
+                        Lookahead<W> first{};
+                        bool empty = suffixFirst(p, 0, first);
+                        if (mergeInto(firstSets[left[p]], first)) changed = true;
+                        if (empty && !nullable[left[p]]) {
+                            nullable[left[p]] = 1;
+                            changed = true;
+                        }
+                    }
+                }
+            }
+
+            // 把产生式从dot开始的后缀的First集并入first，返回后缀能否推导出ε
+            constexpr bool suffixFirst(int production, int dot, Lookahead<W>& first) const {
+                for (int k = dot; k < length(production); k++) {
+                    int symbol = symbolAt(production, k);
+                    if (symbol < terminalCount()) {
+                        first[symbol / 64] |= uint64_t(1) << (symbol % 64);
+                        return false;
+                    }
+                    int nonTerminal = symbol - terminalCount();
+                    mergeInto(first, firstSets[nonTerminal]);
+                    if (!nullable[nonTerminal]) return false;
+                }
+                return true;
+            }
+
+            constexpr std::vector<Item> closure(const std::vector<Item>& kernel) const {
+                std::vector<Item> items = kernel;
+                std::vector<size_t> workList;
+                std::vector<int> added(productionCount(), -1);  // 产生式 -> 点在最左端的项目的位置
+                for (size_t k = 0; k < items.size(); k++) {
+                    workList.push_back(k);
+                    if (items[k].dot == 0) added[items[k].production] = static_cast<int>(k);
+                }
+
+                while (!workList.empty()) {
+                    size_t current = workList.back();
+                    workList.pop_back();
+                    int production = items[current].production;
+                    int dot = items[current].dot;
+                    if (dot >= length(production) || symbolAt(production, dot) < terminalCount()) continue;
+
+                    // 新项目的向前看符号为First(βa)
+                    Lookahead<W> lookahead{};
+                    if (suffixFirst(production, dot + 1, lookahead)) mergeInto(lookahead, items[current].lookahead);
+                    for (int p : productionsOf[symbolAt(production, dot) - terminalCount()]) {
+                        if (added[p] < 0) {
+                            added[p] = static_cast<int>(items.size());
+                            workList.push_back(items.size());
+                            items.push_back(Item{p, 0, lookahead});
+                        } else if (mergeInto(items[added[p]].lookahead, lookahead)) {
+                            workList.push_back(static_cast<size_t>(added[p]));
+                        }
+                    }
+                }
+
+                // 与SyntaxAnalyzer::closure的结果相同，按(产生式, 点位置)排列
+                std::sort(items.begin(), items.end(), [](const Item& a, const Item& b) {
+                    return a.production != b.production ? a.production < b.production : a.dot < b.dot;
+                });
+                return items;
+            }
+
+            // 按核心查找状态，不存在时添加新状态；桶中只比较哈希值相同的核心
+            constexpr size_t findOrAddKernel(std::vector<Item> kernel) {
+                uint64_t hash = kernelHash(kernel);
+                std::vector<size_t>& bucket = kernelBuckets[hash % kernelBuckets.size()];
+                for (size_t state : bucket) {
+                    if (kernelHashes[state] == hash && kernels[state] == kernel) return state;
+                }
+                bucket.push_back(kernels.size());
+                kernels.push_back(std::move(kernel));
+                kernelHashes.push_back(hash);
+                return kernels.size() - 1;
+            }
+
+            static constexpr uint64_t kernelHash(const std::vector<Item>& kernel) {
+                uint64_t hash = 14695981039346656037ULL;
+                auto feed = [&hash](uint64_t value) { hash = (hash ^ value) * 1099511628211ULL; };
+                for (const auto& item : kernel) {
+                    feed(static_cast<uint64_t>(item.production) << 32 | static_cast<uint32_t>(item.dot));
+                    for (uint64_t word : item.lookahead) feed(word);
+                }
+                return hash;
+            }
+
+            // 冲突时的优先级与SyntaxAnalyzer相同：接受 > 移进 > 规约，两个规约之间选择编号较小的产生式
+            constexpr void setAction(int state, int terminal, int32_t code) {
+                int32_t& entry = action[static_cast<size_t>(state) * terminalCount() + terminal];
+                if (entry == LRAction::ERROR) {
+                    entry = code;
+                    return;
+                }
+                if (entry == code) return;
+                conflictCount++;
+                auto rank = [](int32_t value) {
+                    return value == LRAction::ACCEPT ? 0 : LRAction::isShift(value) ? 1 : 2;
+                };
+                if (rank(code) != rank(entry)) {
+                    if (rank(code) < rank(entry)) entry = code;
+                } else if (LRAction::isReduce(code) &&
+                           LRAction::reduceProduction(code) < LRAction::reduceProduction(entry)) {
+                    entry = code;
+                }
+            }
+
+            // 与buildLR1Automaton相同的广度优先构造：先填规约，再按符号首次出现的顺序求后继
+            constexpr void build() {
+                Lookahead<W> endLookahead{};
+                int end = terminalCount() - 1;
+                endLookahead[end / 64] |= uint64_t(1) << (end % 64);
+                findOrAddKernel({Item{0, 0, endLookahead}});
+
+                for (size_t state = 0; state < kernels.size(); state++) {
+                    action.resize((state + 1) * terminalCount(), LRAction::ERROR);
+                    goTo.resize((state + 1) * nonTerminalCount(), -1);
+                    std::vector<Item> items = closure(kernels[state]);
+
+                    for (const auto& item : items) {
+                        if (item.dot < length(item.production)) continue;
+                        for (int terminal = 0; terminal < terminalCount(); terminal++) {
+                            if ((item.lookahead[terminal / 64] >> (terminal % 64) & 1) == 0) continue;
+                            if (item.production == 0) {
+                                if (terminal == end) setAction(static_cast<int>(state), terminal, LRAction::ACCEPT);
+                            } else {
+                                setAction(static_cast<int>(state), terminal, LRAction::reduce(item.production));
+                            }
+                        }
+                    }
+
+                    std::vector<int> groupSymbols;
+                    std::vector<std::vector<Item>> groups;
+                    for (const auto& item : items) {
+                        if (item.dot >= length(item.production)) continue;
+                        int symbol = symbolAt(item.production, item.dot);
+                        size_t group = 0;
+                        while (group < groupSymbols.size() && groupSymbols[group] != symbol) group++;
+                        if (group == groupSymbols.size()) {
+                            groupSymbols.push_back(symbol);
+                            groups.emplace_back();
+                        }
+                        groups[group].push_back(Item{item.production, item.dot + 1, item.lookahead});
+                    }
+
+                    for (size_t group = 0; group < groups.size(); group++) {
+                        size_t target = findOrAddKernel(std::move(groups[group]));
+
+                        int symbol = groupSymbols[group];
+                        if (symbol < terminalCount()) {
+                            setAction(static_cast<int>(state), symbol, LRAction::shift(static_cast<int>(target)));
+                        } else {
+                            goTo[state * nonTerminalCount() + (symbol - terminalCount())] = static_cast<int32_t>(target);
+                        }
+                    }
+                }
+            }
+        };
+
+        template <size_t W>
+        constexpr Automaton<W> construct(std::string_view text) {
+            Automaton<W> automaton;
+            if (!automaton.parse(text)) return automaton;
+            automaton.computeFirstSets();
+            automaton.build();
+            automaton.valid = true;
+            return automaton;
+        }
+    }
+
+    // 向前看符号位图的字数，第一遍只读入文法
+    constexpr size_t lookaheadWords(std::string_view text) {
+        detail::GrammarText grammar;
+        if (!grammar.parse(text)) return 1;
+        return static_cast<size_t>(grammar.terminalCount() + 63) / 64;
+    }
+
+    template <size_t W>
+    constexpr TableSizes measure(std::string_view text) {
+        detail::Automaton<W> automaton = detail::construct<W>(text);
+        TableSizes sizes;
+        if (!automaton.valid) return sizes;
+        sizes.valid = true;
+        sizes.stateCount = static_cast<int>(automaton.kernels.size());
+        sizes.terminalCount = automaton.terminalCount();
+        sizes.nonTerminalCount = automaton.nonTerminalCount();
+        sizes.productionCount = automaton.productionCount();
+        sizes.rightCount = static_cast<int>(automaton.right.size());
+        for (auto name : automaton.terminals) sizes.nameBytes += static_cast<int>(name.size());
+        for (auto name : automaton.nonTerminals) sizes.nameBytes += static_cast<int>(name.size());
+        sizes.conflictCount = automaton.conflictCount;
+        sizes.tokenBindingCount = static_cast<int>(automaton.tokenBindings.size());
+        return sizes;
+    }
+
+    // 编译期分析表的存储，布局与ParseTable相同
+    template <TableSizes S>
+    struct TableData {
+        std::array<int32_t, static_cast<size_t>(S.stateCount) * S.terminalCount> action{};
+        std::array<int32_t, static_cast<size_t>(S.stateCount) * S.nonTerminalCount> goTo{};
+        std::array<int32_t, S.productionCount> productionLeft{};
+        std::array<int32_t, S.productionCount> productionLength{};
+        std::array<uint32_t, S.productionCount + 1> productionRightOffsets{};
+        std::array<int32_t, S.rightCount + 1> productionRight{};  // 多留一项，所有产生式都为空时数组也不为空
+        std::array<uint32_t, S.terminalCount + S.nonTerminalCount + 1> nameOffsets{};
+        std::array<char, S.nameBytes + 1> nameData{};
+        std::array<int32_t, S.tokenBindingCount + 1> tokenBindings{};
+    };
+
+    template <size_t W, TableSizes S>
+    constexpr TableData<S> fill(std::string_view text) {
+        detail::Automaton<W> automaton = detail::construct<W>(text);
+        TableData<S> data;
+        std::copy(automaton.action.begin(), automaton.action.end(), data.action.begin());
+        std::copy(automaton.goTo.begin(), automaton.goTo.end(), data.goTo.begin());
+        for (int p = 0; p < S.productionCount; p++) {
+            data.productionLeft[p] = automaton.left[p];
+            data.productionLength[p] = automaton.length(p);
+            data.productionRightOffsets[p + 1] = static_cast<uint32_t>(automaton.rightStart[p + 1]);
+        }
+        std::copy(automaton.right.begin(), automaton.right.end(), data.productionRight.begin());
+
+        size_t symbol = 0, offset = 0;
+        auto addName = [&](std::string_view name) {
+            for (char c : name) data.nameData[offset++] = c;
+            data.nameOffsets[++symbol] = static_cast<uint32_t>(offset);
+        };
+        for (auto name : automaton.terminals) addName(name);
+        for (auto name : automaton.nonTerminals) addName(name);
+        std::copy(automaton.tokenBindings.begin(), automaton.tokenBindings.end(), data.tokenBindings.begin());
+        return data;
+    }
+
+    template <TableSizes S>
+    constexpr ParseTableView makeView(const TableData<S>& data) {
+        ParseTableView view;
+        view.stateCount = S.stateCount;
+        view.terminalCount = S.terminalCount;
+        view.nonTerminalCount = S.nonTerminalCount;
+        view.productionCount = S.productionCount;
+        view.endMarker = S.terminalCount - 1;
+        view.action = data.action.data();
+        view.goTo = data.goTo.data();
+        view.productionLeft = data.productionLeft.data();
+        view.productionLength = data.productionLength.data();
+        view.productionRightOffsets = data.productionRightOffsets.data();
+        view.productionRight = data.productionRight.data();
+        view.nameOffsets = data.nameOffsets.data();
+        view.nameData = data.nameData.data();
+        view.tokenBindingCount = S.tokenBindingCount;
+        view.tokenBindings = data.tokenBindings.data();
+        return view;
+    }
+}
+
+// 源代码中的文法在编译期得到的分析表，数组位于只读数据段
+template <ConstexprLR::FixedString Text>
+struct CompiledGrammar {
+    static constexpr size_t words = ConstexprLR::lookaheadWords(Text.view());
+    static constexpr ConstexprLR::TableSizes sizes = ConstexprLR::measure<words>(Text.view());
+    static_assert(sizes.valid, "文法中没有产生式，或者含有无法识别的%指令");
+
+    static constexpr int conflictCount = sizes.conflictCount;
+    static constexpr ConstexprLR::TableData<sizes> data = ConstexprLR::fill<words, sizes>(Text.view());
+    static constexpr ParseTableView table = ConstexprLR::makeView(data);
+};
+
+#endif //SD2_COMPILEDGRAMMAR_H
@@ -0,0 +1,161 @@
+#ifndef SD2_GLRPARSER_H
+#define SD2_GLRPARSER_H
+
+#include "ParseTable.h"
+#include <cstdint>
+#include <ostream>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// GLR用的多动作表：只保存有冲突的表项的全部动作，其余表项直接使用ParseTableView::action
+class MultiActionTable {
+public:
+    void clear() {
+        conflicted.clear();
+        cells.clear();
+    }
+    void reset(int stateCount, int terminalCount) {
+        clear();
+        columns = terminalCount;
+        conflicted.assign(static_cast<size_t>(stateCount) * terminalCount, 0);
+    }
+    void add(int state, int terminal, int32_t action);
+
+    bool isConflicted(int state, int terminal) const {
+        size_t cell = static_cast<size_t>(state) * columns + terminal;
+        return cell < conflicted.size() && conflicted[cell];
+    }
+    std::span<const int32_t> actionsAt(int state, int terminal) const {
+        return cells.at(static_cast<uint32_t>(static_cast<size_t>(state) * columns + terminal));
+    }
+    size_t conflictCount() const { return cells.size(); }
+
+private:
+    int columns = 0;
+    std::vector<char> conflicted;                                // stateCount × terminalCount
+    std::unordered_map<uint32_t, std::vector<int32_t>> cells;    // 有冲突的表项 -> 全部动作
+};
+
+// 共享压缩分析森林（SPPF）的结点：符号结点按(符号, 起点, 终点)唯一，
+// 同一符号结点的多种推导是它的多个打包结点，子树在不同推导之间共享
+struct ForestNode {
+    int32_t symbol;       // 统一符号编号，终结符结点没有推导
+    uint32_t start;       // 覆盖输入的[start, end)
+    uint32_t end;
+    uint32_t firstFamily; // 第一个打包结点，没有推导时为NONE
+    uint32_t familyCount;
+};
+
+// 打包结点：符号结点的一种推导
+struct PackedNode {
+    int32_t production;
+    uint32_t childStart;  // 子结点（符号结点）在children中的起始位置
+    uint32_t childCount;
+    uint32_t next;        // 同一符号结点的下一个打包结点
+};
+
+class SharedPackedForest {
+public:
+    static constexpr uint32_t NONE = UINT32_MAX;
+
+    void clear() {
+        nodes.clear();
+        families.clear();
+        children.clear();
+        rootNode = NONE;
+    }
+    void reserve(size_t tokenCount) {
+        nodes.reserve(tokenCount * 2);
+        families.reserve(tokenCount * 2);
+        children.reserve(tokenCount * 2);
+    }
+    uint32_t addNode(int symbol, uint32_t start, uint32_t end) {
+        nodes.push_back({symbol, start, end, NONE, 0});
+        return static_cast<uint32_t>(nodes.size() - 1);
+    }
+    // 给符号结点加上一种推导，已有同样的推导时不重复添加；返回是否新增
+    bool addFamily(uint32_t node, int production, std::span<const uint32_t> childNodes);
+    void setRoot(uint32_t node) { rootNode = node; }
+
+    bool empty() const { return rootNode == NONE; }
+    uint32_t root() const { return rootNode; }
+    size_t size() const { return nodes.size(); }
+    const ForestNode& node(uint32_t index) const { return nodes[index]; }
+    const PackedNode& family(uint32_t index) const { return families[index]; }
+    std::span<const uint32_t> childrenOf(const PackedNode& packed) const {
+        return {children.data() + packed.childStart, packed.childCount};
+    }
+
+    size_t ambiguousNodeCount() const;     // 有多种推导的符号结点个数
+    uint64_t derivationCount() const;      // 根的不同语法树个数，超过UINT64_MAX时取UINT64_MAX
+    // 打印森林：有歧义的结点列出全部推导，已经打印过的共享结点只给出引用
+    void print(std::ostream& out, const ParseTableView& table, std::span<const std::string> tokenValues = {}) const;
+
+private:
+    std::vector<ForestNode> nodes;
+    std::vector<PackedNode> families;
+    std::vector<uint32_t> children;
+    uint32_t rootNode = NONE;
+};
+
+// GLR分析的结果
+struct GLRResult {
+    bool accepted = false;
+    size_t errorPosition = 0;  // 出错时所有栈都无法处理的输入位置
+    int errorState = -1;       // 出错时某个栈顶的状态
+    size_t stackNodes = 0;     // 图结构栈的结点总数
+};
+
+/*
+ * GLR分析器：遇到有冲突的表项时在图结构栈（GSS）上分叉，各分支同时前进；
+ * 到达相同状态的栈顶合并为一个结点，同一段输入归约出的同一符号在森林中只出现一次。
+ * 只有一个栈顶且表项没有冲突时按普通LR的方式直接移进和归约，确定的部分保持LR的速度。
+ * 空产生式按Farshi的方法处理：给已有结点添加新边后，重新尝试经过这条边的全部归约。
+ */
+class GLRParser {
+public:
+    GLRParser(const ParseTableView& table, const MultiActionTable& multiActions) : table(table), multi(multiActions) {}
+
+    // input为终结符编号序列，以#结尾
+    GLRResult parse(std::span<const int> input, SharedPackedForest& forest);
+
+private:
+    struct StackNode {
+        int32_t state;
+        uint32_t level;      // 所在的输入位置
+        uint32_t firstEdge;  // 指向前驱结点的边组成的链表
+    };
+    struct StackEdge {
+        uint32_t target;     // 前驱结点
+        uint32_t forestNode; // 这条边上的符号在森林中的结点
+        uint32_t next;
+    };
+    struct Reduction {
+        uint32_t node;
+        int production;
+        uint32_t requiredEdge;  // 路径必须经过的边，NONE表示任意路径
+    };
+
+    const ParseTableView& table;
+    const MultiActionTable& multi;
+    std::vector<StackNode> stackNodes;
+    std::vector<StackEdge> stackEdges;
+    std::vector<uint32_t> frontier;       // 当前输入位置上的全部栈顶
+    std::vector<uint32_t> levelSymbols;   // 当前输入位置结束的非终结符结点，用于共享
+    std::vector<Reduction> pending;
+    std::vector<uint32_t> pathSymbols;    // 确定的归约中右部各符号的森林结点，多次归约共用
+
+    std::span<const int32_t> actionsOf(int state, int terminal, int32_t& single) const;
+    uint32_t findNode(int state) const;
+    uint32_t newNode(int state, uint32_t level);
+    uint32_t addEdge(uint32_t from, uint32_t to, uint32_t forestNode);
+    bool hasEdge(uint32_t from, uint32_t to) const;
+    uint32_t symbolNode(SharedPackedForest& forest, int symbol, uint32_t start, uint32_t end);
+    void enqueueReductions(uint32_t node, int terminal, uint32_t requiredEdge, bool nonEmptyOnly);
+    bool reduceDeterministic(uint32_t node, int production, uint32_t position, SharedPackedForest& forest);
+    void reduceAll(int terminal, uint32_t position, SharedPackedForest& forest);
+};
+
+#endif //SD2_GLRPARSER_H
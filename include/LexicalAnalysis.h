@@ -6,6 +6,11 @@
 #include <map>
 #include <set>
 #include <memory>
+#include <iosfwd>
+#include <cstdint>
+#include <string_view>
+#include <unordered_set>
+#include "LineIndex.h"
 
 // Token类型枚举
 enum TokenType {
@@ -21,7 +26,7 @@ enum TokenType {
 struct Token {
     TokenType type;
     std::string value;
-    int line_number;
+    size_t offset;//Token首字节在源代码中的偏移量，行号列号通过LineIndex按需换算
 };
 
 // NFA状态节点
@@ -29,7 +34,7 @@ struct NFAState {
     int id;//状态的唯一标识符
     bool is_final;//是否为终止状态
     TokenType token_type;//终止状态对应的Token类型
-    std::map<char, std::vector<std::shared_ptr<NFAState>>> transitions;//字符到状态的映射,存储从当前状态出发，经过某个字符到达的状态集合
+    std::map<unsigned char, std::vector<std::shared_ptr<NFAState>>> transitions;//字节到状态的映射，非ASCII字符以UTF-8字节序列表示,存储从当前状态出发，经过某个字符到达的状态集合
     std::vector<std::shared_ptr<NFAState>> epsilon_transitions;//ε-闭包,存储从当前状态出发，经过ε到达的状态集合
 };
 
@@ -38,9 +43,60 @@ struct DFAState {
     int id;
     bool is_final;
     TokenType token_type;//终止状态对应的Token类型
-    std::map<char, std::shared_ptr<DFAState>> transitions;//字符到状态的映射,存储从当前状态出发，经过某个字符到达的状态集合
+    std::map<unsigned char, std::shared_ptr<DFAState>> transitions;//字节到状态的映射,存储从当前状态出发，经过某个字符到达的状态集合
 };
 
+// 编译完成的词法分析器：关键字表和按字节索引的稠密DFA转移表
+// 构建完成后不再修改，可以按值保存，也可以用const&在多个线程间共享而无需加锁
+class CompiledLexer {
+public:
+    CompiledLexer() = default;
+
+    int startState() const { return 0; }
+    // 返回经过字节c到达的状态，没有转移时返回-1
+    int next(int state, unsigned char c) const {
+        return transitions[static_cast<size_t>(state) * 256 + c];
+    }
+    bool isFinal(int state) const { return accepting[state]; }
+    TokenType tokenType(int state) const { return token_types[state]; }
+    bool isKeyword(std::string_view word) const { return keywords.find(word) != keywords.end(); }
+    size_t stateCount() const { return token_types.size(); }
+
+private:
+    friend class LexicalAnalysis;  // 只能由LexicalAnalysis从DFA编译得到
+
+    std::vector<int32_t> transitions;     // 状态数×256的转移表，-1表示没有转移
+    std::vector<char> accepting;          // 各状态是否为终态
+    std::vector<TokenType> token_types;   // 终态对应的Token类型
+    // 支持用string_view直接查找，避免为每个候选Token构造std::string
+    struct KeywordHash {
+        using is_transparent = void;
+        size_t operator()(std::string_view word) const { return std::hash<std::string_view>()(word); }
+    };
+    std::unordered_set<std::string, KeywordHash, std::equal_to<>> keywords;
+};
+
+// 单次扫描的状态：只保存游标位置和按需构建的行号索引，
+// 自动机通过const&引用共享，每个线程为自己的源代码创建一个扫描器即可
+class LexicalScanner {
+public:
+    LexicalScanner(const CompiledLexer& lexer, const std::string& source_code);
+
+    // 读取下一个Token，源代码已扫描完时返回false
+    bool next(Token& token);
+    // 扫描剩余的全部源代码
+    std::vector<Token> scanAll();
+
+private:
+    const CompiledLexer& lexer;
+    const std::string& source_code;
+    size_t i;                          // 当前扫描位置
+    std::unique_ptr<LineIndex> lines;  // 仅在输出错误信息时构建
+
+    std::string location(size_t offset);
+};
+
+// 文法加载与自动机构建：读取文法规则，构造NFA并用子集法转换为DFA，最后编译为CompiledLexer
 class LexicalAnalysis {
 private:
     // NFA相关
@@ -58,12 +114,34 @@ private:
     };
     std::vector<Rule> grammar_rules;//存储输入进来的文法规则
 
+    CompiledLexer compiled_lexer;//由DFA编译得到的只读词法分析器
+
+    // UTF-8多字节序列的后缀状态共享表：键为 该状态要匹配的字节范围 + 匹配后到达的状态
+    struct Utf8SuffixKey {
+        std::vector<std::pair<unsigned char, unsigned char>> ranges;
+        std::vector<const NFAState*> targets;
+        bool operator<(const Utf8SuffixKey& other) const {
+            if (ranges != other.ranges) return ranges < other.ranges;
+            return targets < other.targets;
+        }
+    };
+    std::map<Utf8SuffixKey, std::shared_ptr<NFAState>> utf8_suffix_states;
+
     // 私有方法
     void buildNFA(const std::string& grammar_file);
     void convertNFAtoDFA();//使用子集法
     std::shared_ptr<NFAState> createNFAForPattern(const std::string& pattern, TokenType type);
     std::set<std::shared_ptr<NFAState>> getEpsilonClosure(const std::set<std::shared_ptr<NFAState>>& states);
-    std::set<std::shared_ptr<NFAState>> move(const std::set<std::shared_ptr<NFAState>>& states, char c);
+    std::set<std::shared_ptr<NFAState>> move(const std::set<std::shared_ptr<NFAState>>& states, unsigned char c);
+    // 把Unicode码点区间编译为UTF-8字节序列的NFA路径，自动机始终按字节运行
+    void addCodepointRange(const std::shared_ptr<NFAState>& from,
+                           const std::vector<std::shared_ptr<NFAState>>& targets,
+                           uint32_t lo, uint32_t hi);
+    // 标识符字符类：ASCII字母、下划线（后续字符还包括数字）以及C11允许的Unicode字符
+    void addIdentifierClass(const std::shared_ptr<NFAState>& from,
+                            const std::vector<std::shared_ptr<NFAState>>& targets,
+                            bool continuation);
+    CompiledLexer compileDFA() const;//把DFA状态图展开为稠密转移表
     //shared_ptr是C++11引入的智能指针，用于自动管理内存，避免内存泄漏，特性是共享对象，对于自动机的状态节点使用shared_ptr可以方便地管理状态之间的引用关系，避免手动管理内存带来的复杂性和错误
     //引用计数，只有当引用计数为0时才会释放内存
 public:
@@ -73,14 +151,22 @@ public:
     // 加载文法文件并构建自动机
     bool loadGrammar(const std::string& grammar_file);
 
-    // 分析源代码
-    std::vector<Token> analyze(const std::string& source_code);
+    // 已编译的词法分析器；返回的引用指向本对象的成员，重新loadGrammar后失效。
+    // CompiledLexer不引用本对象，需要在loadGrammar之后继续使用时复制一份
+    const CompiledLexer& lexer() const { return compiled_lexer; }
+
+    // 分析源代码，等价于用lexer()创建一个LexicalScanner扫描全部源代码
+    std::vector<Token> analyze(const std::string& source_code) const;
 
     // 从文件读取源代码
     static std::string readSourceFile(const std::string& filename);
 
-    // 输出Token序列
-    static void printTokens(const std::vector<Token>& tokens);
+    // 输出Token序列，行号由源代码对应的LineIndex换算
+    static void printTokens(const std::vector<Token>& tokens, const LineIndex& lines);
+    static void printTokens(const std::vector<Token>& tokens, const LineIndex& lines, std::ostream& out);
+
+    // Token类型的输出名称
+    static const char* tokenTypeName(TokenType type);
 };
 
 #endif //SD2_LEXICALANALYSIS_H
\ No newline at end of file
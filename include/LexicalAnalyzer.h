@@ -2,6 +2,7 @@
 #define SD2_LEXICAL_ANALYZER_H
 
 #include <string>
+#include <string_view>
 #include <vector>
 
 // Token类型枚举
@@ -15,6 +16,12 @@ enum TokenType {
     COMPLEX
 };
 
+// Token类型的名称，下标与TokenType的取值一致，文法文件的%bind指令使用这些名称
+constexpr int TOKEN_TYPE_COUNT = 7;
+constexpr std::string_view TOKEN_TYPE_NAMES[TOKEN_TYPE_COUNT] = {
+    "KEYWORD", "IDENTIFIER", "CONSTANT", "LIMITER", "OPERATOR", "INVALID", "COMPLEX"
+};
+
 // Token 结构体
 struct Token {
     TokenType type;
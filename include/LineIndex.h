@@ -0,0 +1,24 @@
+#ifndef SD2_LINEINDEX_H
+#define SD2_LINEINDEX_H
+
+#include <string>
+#include <vector>
+#include <cstddef>
+
+// 换行符偏移索引：对源代码只扫描一次，记录每一行起始位置的字节偏移
+// Token中只保存字节偏移，行号和列号在需要输出诊断信息时再通过二分查找换算出来
+class LineIndex {
+public:
+    LineIndex() = default;
+    explicit LineIndex(const std::string& source);
+
+    int line(size_t offset) const;    // 偏移量所在的行号（从1开始）
+    int column(size_t offset) const;  // 偏移量所在的列号（从1开始，按字节计）
+    size_t lineCount() const { return line_starts.size(); }
+
+private:
+    std::vector<size_t> line_starts;  // 第i行（从0计）首字节的偏移量，line_starts[0]恒为0
+    size_t lineOf(size_t offset) const;
+};
+
+#endif //SD2_LINEINDEX_H
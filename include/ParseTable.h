@@ -0,0 +1,136 @@
+#ifndef SD2_PARSETABLE_H
+#define SD2_PARSETABLE_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// ACTION表项的整数编码：
+//   0        出错（没有定义动作）
+//   n > 0    移进，转到状态 n-1
+//   n < 0    按产生式 -n-1 规约；按0号增广产生式 S' -> S 规约即为接受（编码为-1）
+namespace LRAction {
+    constexpr int32_t ERROR = 0;
+    constexpr int32_t ACCEPT = -1;
+
+    constexpr int32_t shift(int state) { return state + 1; }
+    constexpr int32_t reduce(int production) { return -(production + 1); }
+
+    constexpr bool isShift(int32_t action) { return action > 0; }
+    constexpr bool isReduce(int32_t action) { return action < ACCEPT; }
+    constexpr int shiftTarget(int32_t action) { return action - 1; }
+    constexpr int reduceProduction(int32_t action) { return -action - 1; }
+}
+
+// 稠密LR分析表的只读视图：只包含计数和指向各数组的指针，不拥有数据。
+// 数据可以在ParseTable的成员中，也可以直接位于映射到内存的分析表文件中，分析过程只通过视图访问分析表
+// 访问函数都是constexpr，分析表是编译期常量时（见CompiledGrammar.h）查表可以在编译期完成
+// 符号统一编号：终结符为 0 .. terminalCount-1（除#外按名称升序，#在最后），非终结符n编号为 terminalCount+n
+struct ParseTableView {
+    int32_t stateCount = 0;
+    int32_t terminalCount = 0;
+    int32_t nonTerminalCount = 0;
+    int32_t productionCount = 0;
+    int32_t endMarker = -1;                          // 结束符号#的终结符编号
+    const int32_t* action = nullptr;                 // stateCount × terminalCount，编码见LRAction
+    const int32_t* goTo = nullptr;                   // stateCount × nonTerminalCount，-1表示没有转移
+    const int32_t* productionLeft = nullptr;         // 产生式编号 -> 左部非终结符编号
+    const int32_t* productionLength = nullptr;       // 产生式编号 -> 右部符号个数
+    const uint32_t* productionRightOffsets = nullptr;  // 产生式p的右部为productionRight[offsets[p], offsets[p+1])
+    const int32_t* productionRight = nullptr;        // 全部产生式右部的统一符号编号
+    const uint32_t* nameOffsets = nullptr;           // 符号s的名称为nameData[offsets[s], offsets[s+1])
+    const char* nameData = nullptr;
+    int32_t tokenBindingCount = 0;
+    const int32_t* tokenBindings = nullptr;          // 词法Token类型 -> 文法用%bind绑定的终结符编号，-1表示没有绑定
+
+    constexpr int32_t actionAt(int state, int terminal) const {
+        return action[static_cast<size_t>(state) * terminalCount + terminal];
+    }
+    constexpr int32_t gotoAt(int state, int nonTerminal) const {
+        return goTo[static_cast<size_t>(state) * nonTerminalCount + nonTerminal];
+    }
+
+    constexpr std::string_view symbolName(int symbol) const {
+        return {nameData + nameOffsets[symbol], nameOffsets[symbol + 1] - nameOffsets[symbol]};
+    }
+    constexpr std::string_view nonTerminalName(int nonTerminal) const { return symbolName(terminalCount + nonTerminal); }
+
+    // Token类型绑定的终结符编号，没有绑定时返回-1
+    constexpr int boundTerminal(int tokenType) const {
+        return tokenType >= 0 && tokenType < tokenBindingCount ? tokenBindings[tokenType] : -1;
+    }
+
+    // 按名称查找终结符编号（不包括#），不存在时返回-1
+    constexpr int findTerminal(std::string_view name) const {
+        int low = 0, high = terminalCount;
+        while (low < high) {
+            int mid = (low + high) / 2;
+            if (mid == endMarker) {
+                // #不参与排序，它总在最后
+                high = mid;
+                continue;
+            }
+            std::string_view midName = symbolName(mid);
+            if (midName == name) return mid;
+            if (midName < name) low = mid + 1;
+            else high = mid;
+        }
+        return -1;
+    }
+};
+
+// 稠密的LR分析表：终结符和非终结符分别编号为从0开始的连续整数，
+// ACTION/GOTO表按 状态×符号 展开为一维int32_t数组，分析时每一步只需一次数组访问。
+// 各数组的布局与分析表文件中的布局相同，view()得到的视图与映射文件得到的视图可以互换
+struct ParseTable {
+    int32_t stateCount = 0;
+    int32_t terminalCount = 0;
+    int32_t nonTerminalCount = 0;
+    int32_t endMarker = -1;
+    std::vector<int32_t> action;
+    std::vector<int32_t> goTo;
+    std::vector<int32_t> productionLeft;
+    std::vector<int32_t> productionLength;
+    std::vector<uint32_t> productionRightOffsets = {0};
+    std::vector<int32_t> productionRight;
+    std::vector<uint32_t> nameOffsets = {0};
+    std::string nameData;
+    std::vector<int32_t> tokenBindings;
+
+    // 依次登记符号名：先全部终结符，再全部非终结符
+    void addName(std::string_view name) {
+        nameData += name;
+        nameOffsets.push_back(static_cast<uint32_t>(nameData.size()));
+    }
+
+    // 登记一个产生式，right为右部的统一符号编号
+    void addProduction(int32_t left, const std::vector<int32_t>& right) {
+        productionLeft.push_back(left);
+        productionLength.push_back(static_cast<int32_t>(right.size()));
+        productionRight.insert(productionRight.end(), right.begin(), right.end());
+        productionRightOffsets.push_back(static_cast<uint32_t>(productionRight.size()));
+    }
+
+    ParseTableView view() const {
+        ParseTableView view;
+        view.stateCount = stateCount;
+        view.terminalCount = terminalCount;
+        view.nonTerminalCount = nonTerminalCount;
+        view.productionCount = static_cast<int32_t>(productionLeft.size());
+        view.endMarker = endMarker;
+        view.action = action.data();
+        view.goTo = goTo.data();
+        view.productionLeft = productionLeft.data();
+        view.productionLength = productionLength.data();
+        view.productionRightOffsets = productionRightOffsets.data();
+        view.productionRight = productionRight.data();
+        view.nameOffsets = nameOffsets.data();
+        view.nameData = nameData.data();
+        view.tokenBindingCount = static_cast<int32_t>(tokenBindings.size());
+        view.tokenBindings = tokenBindings.data();
+        return view;
+    }
+};
+
+#endif //SD2_PARSETABLE_H
@@ -0,0 +1,94 @@
+#ifndef SD2_PARSETABLEFILE_H
+#define SD2_PARSETABLEFILE_H
+
+#include "ParseTable.h"
+#include <cstdint>
+#include <string>
+
+/*
+ * 分析表文件：ParseTable各数组原样写入一个文件，使用时把整个文件映射到内存，
+ * ParseTableView的指针直接指向映射区，不需要任何解析或拷贝。
+ * 映射是只读共享的，多个进程打开同一个文件时共用页缓存中的同一份数据。
+ *
+ * 文件布局（本机字节序，各段按8字节对齐）：
+ *   ParseTableFileHeader
+ *   action        int32_t[stateCount × terminalCount]
+ *   goTo          int32_t[stateCount × nonTerminalCount]
+ *   productionLeft / productionLength   int32_t[productionCount]
+ *   productionRightOffsets  uint32_t[productionCount + 1]
+ *   productionRight         int32_t[...]
+ *   nameOffsets   uint32_t[terminalCount + nonTerminalCount + 1]
+ *   nameData      char[...]
+ *   tokenBindings int32_t[tokenBindingCount]
+ * 文件头中的grammarHash由文法文件内容和构造方式求出，文法改变后旧文件自动失效。
+ */
+struct ParseTableFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t headerSize;
+    uint64_t grammarHash;
+    uint64_t fileSize;
+    int32_t stateCount;
+    int32_t terminalCount;
+    int32_t nonTerminalCount;
+    int32_t productionCount;
+    int32_t endMarker;
+    uint32_t productionRightCount;
+    uint32_t nameDataSize;
+    uint32_t tokenBindingCount;
+    // 各段相对文件开头的偏移
+    uint64_t actionOffset;
+    uint64_t gotoOffset;
+    uint64_t productionLeftOffset;
+    uint64_t productionLengthOffset;
+    uint64_t productionRightOffsetsOffset;
+    uint64_t productionRightOffset;
+    uint64_t nameOffsetsOffset;
+    uint64_t nameDataOffset;
+    uint64_t tokenBindingsOffset;
+};
+
+namespace ParseTableFile {
+    constexpr char MAGIC[8] = {'S', 'D', '2', 'L', 'R', 'T', 'B', '\0'};
+    constexpr uint32_t VERSION = 2;  // 版本2增加了Token类型绑定
+
+    // 文法文本与构造方式的64位FNV-1a哈希
+    uint64_t grammarHash(const std::string& grammarText, int constructionMode);
+
+    // 把分析表写入文件：先写一个名字唯一的临时文件再改名，正在映射旧文件的进程不受影响
+    bool write(const std::string& path, const ParseTable& table, uint64_t grammarHash);
+}
+
+// 只读映射的分析表文件，析构时解除映射
+class MappedParseTable {
+public:
+    MappedParseTable() = default;
+    ~MappedParseTable();
+    MappedParseTable(const MappedParseTable&) = delete;
+    MappedParseTable& operator=(const MappedParseTable&) = delete;
+
+    // 映射文件并校验魔数、版本、文法哈希、各段范围以及表中每个状态号、产生式号和符号号，任何一项不符都返回false
+    bool open(const std::string& path, uint64_t expectedHash);
+    void close();
+
+    bool isOpen() const { return data != nullptr; }
+    const ParseTableView& view() const { return tableView; }
+    const std::string& path() const { return mappedPath; }  // open时给出的路径
+
+    // 把映射的文件内容原样写到另一个路径，写法与ParseTableFile::write相同
+    bool saveAs(const std::string& path) const;
+
+private:
+    const unsigned char* data = nullptr;
+    size_t size = 0;
+    std::string mappedPath;
+#ifdef _WIN32
+    void* fileHandle = nullptr;
+    void* mappingHandle = nullptr;
+#endif
+    ParseTableView tableView;
+
+    bool validate(uint64_t expectedHash);
+};
+
+#endif //SD2_PARSETABLEFILE_H
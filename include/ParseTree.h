@@ -0,0 +1,83 @@
+#ifndef SD2_PARSETREE_H
+#define SD2_PARSETREE_H
+
+#include "ParseTable.h"
+#include <cstdint>
+#include <ostream>
+#include <span>
+#include <string>
+#include <vector>
+
+// 语法树的结点。内部结点是一次规约，叶子是一次移进。
+// 结点之间只用下标引用，整棵树中没有指针，也不需要逐个释放。
+// 结点不记录自己在输入中的绝对位置：叶子对应的Token下标等于它左边所有子树的tokenCount之和，
+// 因此一棵子树与它所在的位置无关，增量分析时可以原样放到编辑后的输入中
+struct ParseTreeNode {
+    int32_t symbol;       // 统一符号编号（见ParseTableView），叶子为终结符
+    int32_t production;   // 规约所用的产生式，叶子为-1
+    uint32_t first;       // 子结点在children中的起始位置，叶子为0
+    uint32_t count;       // 子结点个数，叶子和空产生式为0
+    int32_t state;        // 压入这个结点之前栈顶的LR状态，增量分析据此判断子树能否整体复用
+    uint32_t tokenCount;  // 子树覆盖的Token个数，普通叶子为1，空产生式为0
+
+    bool isLeaf() const { return production < 0; }
+};
+
+/*
+ * 分析过程中构造的语法树。结点和子结点下标分别顺序追加在两块连续存储中，
+ * 分配就是移动末尾，一次规约的子结点在children中占一段连续区间。
+ * clear只重置长度、保留容量，反复分析时不再分配内存；整棵树随ParseTree一起释放。
+ * 增量分析（SyntaxAnalyzer::reparse）在同一块存储中追加新结点并引用旧树中未改变的子树，旧的根成为垃圾，
+ * 垃圾过多时由下一次完整分析清除。
+ */
+class ParseTree {
+public:
+    void clear() {
+        nodes.clear();
+        children.clear();
+        rootNode = NO_NODE;
+    }
+    void reserve(size_t tokenCount) {
+        nodes.reserve(tokenCount * 2);
+        children.reserve(tokenCount * 2);
+    }
+
+    // 在state状态下移进一个终结符，返回叶子的下标；error符号的叶子覆盖恢复时丢弃的Token，tokenCount另行给出
+    uint32_t addLeaf(int terminal, int state, uint32_t tokenCount = 1) {
+        nodes.push_back({terminal, -1, 0, 0, state, tokenCount});
+        return static_cast<uint32_t>(nodes.size() - 1);
+    }
+    // 在state状态下按产生式规约，childNodes依次为右部各符号的结点，返回新结点的下标
+    uint32_t addNode(int symbol, int production, int state, std::span<const uint32_t> childNodes) {
+        uint32_t tokenCount = 0;
+        for (uint32_t child : childNodes) tokenCount += nodes[child].tokenCount;
+        nodes.push_back({symbol, production, static_cast<uint32_t>(children.size()),
+                         static_cast<uint32_t>(childNodes.size()), state, tokenCount});
+        children.insert(children.end(), childNodes.begin(), childNodes.end());
+        return static_cast<uint32_t>(nodes.size() - 1);
+    }
+    // 错误恢复时丢弃的Token计入栈顶结点，使后面各叶子的位置仍然正确
+    void extendTokens(uint32_t node, uint32_t tokenCount) { nodes[node].tokenCount += tokenCount; }
+    void setRoot(uint32_t node) { rootNode = node; }
+
+    bool empty() const { return rootNode == NO_NODE; }
+    uint32_t root() const { return rootNode; }
+    size_t size() const { return nodes.size(); }
+    const ParseTreeNode& node(uint32_t index) const { return nodes[index]; }
+    std::span<const uint32_t> childrenOf(uint32_t index) const {
+        const ParseTreeNode& parent = nodes[index];
+        return {children.data() + parent.first, parent.count};
+    }
+
+    // 按缩进打印整棵树，叶子后面给出Token的原文；tokenValues为空时只打印终结符名
+    void print(std::ostream& out, const ParseTableView& table, std::span<const std::string> tokenValues = {}) const;
+
+    static constexpr uint32_t NO_NODE = UINT32_MAX;
+
+private:
+    std::vector<ParseTreeNode> nodes;
+    std::vector<uint32_t> children;  // 各内部结点的子结点下标，每个结点一段
+    uint32_t rootNode = NO_NODE;
+};
+
+#endif //SD2_PARSETREE_H
@@ -2,16 +2,17 @@
 #define SD2_PRODUCTION_H
 
 #include "Symbol.h"
+#include <span>
 
 struct Production {
     Symbol left;
-    std::vector<Symbol> right;
+    std::span<const Symbol> right;  // 右部，指向文法符号池中一段连续的句柄
     int index;
 
-    Production(Symbol l = Symbol(), std::vector<Symbol> r = {}, int i = -1)
+    Production(Symbol l = Symbol(), std::span<const Symbol> r = {}, int i = -1)
         : left(l), right(r), index(i) {}
     // 修改构造函数，使用引用和新的参数类型，重载toString()函数与对应的运算符
-    std::string toString() const;
+    std::string toString(const SymbolTable& symbols) const;
     bool operator==(const Production& other) const;
     bool operator<(const Production& other) const;
 };
@@ -0,0 +1,20 @@
+#ifndef SD2_RECURSIVEASCENTGENERATOR_H
+#define SD2_RECURSIVEASCENTGENERATOR_H
+
+#include "ParseTable.h"
+#include <string>
+
+/*
+ * 递归上升分析器生成器：把分析表直接写成C++代码，每个LR状态对应一个函数。
+ * 移进即调用目标状态的函数；规约时记录左部和右部长度，逐层返回右部长度个函数后，
+ * 在规约句柄下方的状态中按左部转移。分析时不再查表，状态间的跳转由编译器直接编码。
+ *
+ * 生成 <outputStem>.h 和 <outputStem>.cpp 两个文件，不依赖本项目的任何代码，
+ * 全部内容位于命名空间parserName中。sourceName只用于文件开头的说明。
+ */
+namespace RecursiveAscentGenerator {
+    bool generate(const ParseTableView& table, const std::string& outputStem,
+                  const std::string& parserName, const std::string& sourceName);
+}
+
+#endif //SD2_RECURSIVEASCENTGENERATOR_H
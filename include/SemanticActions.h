@@ -0,0 +1,96 @@
+#ifndef SD2_SEMANTICACTIONS_H
+#define SD2_SEMANTICACTIONS_H
+
+#include "SyntaxAnalyzer.h"
+#include <span>
+#include <utility>
+#include <vector>
+
+/*
+ * 按产生式编号登记的语义动作，语义值的类型V在编译期确定。
+ * 分析时值栈与状态栈同步变化：移进时压入Token的值，规约时把右部各符号的值交给该产生式的动作，
+ * 弹出右部并压入动作的结果；接受时栈中只剩开始符号的值。值栈在多次分析之间复用，容量只增不减：
+ * 开始时按Token数预留，ε产生式使栈高于Token数时会扩充一次，之后同样规模的分析不再分配内存。
+ *
+ *     SemanticActions<double> actions(analyzer.parseTableView().productionCount);
+ *     actions.onToken([](const TokenInfo& token, void*) { return std::stod(token.value); });
+ *     actions.on(1, [](std::span<double> v, void*) { return v[0] + v[2]; });  // E -> E + T
+ *     if (actions.run(analyzer, tokens)) use(actions.result());
+ *
+ * 没有登记动作的产生式取右部第一个符号的值（右部为空时取V{}），没有登记Token动作时Token的值为V{}。
+ * 错误恢复时被弹出的值直接丢弃，移进的error符号以及按同步Token恢复时压入的非终结符的值为V{}。
+ */
+template <class V>
+class SemanticActions {
+public:
+    using Action = V (*)(std::span<V> values, void* user);        // values依次为右部各符号的值，可以移出
+    using TokenAction = V (*)(const TokenInfo& token, void* user);
+
+    explicit SemanticActions(int productionCount) : actions(static_cast<size_t>(productionCount), nullptr) {}
+
+    void on(int production, Action action) { actions.at(static_cast<size_t>(production)) = action; }
+    void onToken(TokenAction action) { tokenAction = action; }
+
+    // 分析tokens并执行语义动作，返回是否接受；user原样传给每个动作
+    bool run(SyntaxAnalyzer& analyzer, const std::vector<TokenInfo>& tokens, void* user = nullptr) {
+        input = &tokens;
+        this->user = user;
+        ReductionHooks hooks;
+        hooks.context = this;
+        hooks.begin = &SemanticActions::begin;
+        hooks.shift = &SemanticActions::shift;
+        hooks.reduce = &SemanticActions::reduce;
+        hooks.discard = &SemanticActions::discard;
+        hooks.shiftError = &SemanticActions::shiftError;
+        bool success = analyzer.analyze(tokens, hooks);
+        input = nullptr;
+        if (success) accepted = std::move(values.back());
+        return success;
+    }
+
+    // 最近一次接受的分析中开始符号的值，没有接受过任何输入时为V{}；之后失败的分析不会改变它
+    const V& result() const { return accepted; }
+    V& result() { return accepted; }
+
+private:
+    std::vector<Action> actions;
+    TokenAction tokenAction = nullptr;
+    std::vector<V> values;  // 值栈
+    V accepted{};           // 最近一次接受时开始符号的值
+    const std::vector<TokenInfo>* input = nullptr;
+    void* user = nullptr;
+
+    static void begin(void* context, size_t tokenCount) {
+        auto& self = *static_cast<SemanticActions*>(context);
+        // clear保留容量，上次分析的最大栈高已经体现在容量中；reserve只会扩大
+        self.values.clear();
+        self.values.reserve(tokenCount + 1);
+    }
+
+    static void shift(void* context, uint32_t tokenIndex) {
+        auto& self = *static_cast<SemanticActions*>(context);
+        if (self.tokenAction) self.values.push_back(self.tokenAction((*self.input)[tokenIndex], self.user));
+        else self.values.emplace_back();
+    }
+
+    static void reduce(void* context, int production, int length) {
+        auto& self = *static_cast<SemanticActions*>(context);
+        std::span<V> right(self.values.data() + self.values.size() - length, static_cast<size_t>(length));
+        Action action = self.actions[static_cast<size_t>(production)];
+        V value = action ? action(right, self.user) : length > 0 ? std::move(right[0]) : V{};
+        self.values.erase(self.values.end() - length, self.values.end());
+        self.values.push_back(std::move(value));
+    }
+
+    static void discard(void* context, int count) {
+        auto& self = *static_cast<SemanticActions*>(context);
+        self.values.erase(self.values.end() - count, self.values.end());
+    }
+
+    // error符号以及恢复时压入的非终结符的值为V{}
+    static void shiftError(void* context) {
+        static_cast<SemanticActions*>(context)->values.emplace_back();
+    }
+};
+
+#endif //SD2_SEMANTICACTIONS_H
@@ -1,7 +1,10 @@
 #ifndef SD2_SYMBOL_H
 #define SD2_SYMBOL_H
 
+#include <cstdint>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 #include <vector>
 #include <set>
 
@@ -12,20 +15,49 @@ enum SymbolType {
     END_MARKER      // 结束符号#
 };
 
+// 符号句柄：高2位为符号种类，低30位为该种类内的编号，比较和拷贝都只是32位整数运算
+// 名称保存在文法的SymbolTable中，只在输出时才需要
 struct Symbol {
-    std::string name;
-    SymbolType type;
+    uint32_t handle;
 
-    Symbol(std::string n = "", SymbolType t = TERMINAL) : name(n), type(t) {}
+    constexpr Symbol() : handle(0) {}
+    constexpr Symbol(SymbolType type, uint32_t index)
+        : handle(static_cast<uint32_t>(type) << 30 | index) {}
 
-    bool operator==(const Symbol& other) const {
-        return name == other.name && type == other.type;
-    }
+    constexpr SymbolType type() const { return static_cast<SymbolType>(handle >> 30); }
+    constexpr uint32_t index() const { return handle & 0x3FFFFFFFu; }
 
-    bool operator<(const Symbol& other) const {
-        if (type != other.type) return type < other.type;
-        return name < other.name;
-    }
+    constexpr bool operator==(const Symbol& other) const { return handle == other.handle; }
+    constexpr bool operator!=(const Symbol& other) const { return handle != other.handle; }
+    // 先按种类再按编号比较；SymbolTable按名称顺序分配编号，因此与按(种类, 名称)排序一致
+    constexpr bool operator<(const Symbol& other) const { return handle < other.handle; }
 };
 
-#endif //SD2_SYMBOL_H
\ No newline at end of file
+// 空符号与结束符号各只有一个
+constexpr Symbol EPSILON_SYMBOL(EPSILON, 0);
+constexpr Symbol END_SYMBOL(END_MARKER, 0);
+
+// 文法范围内的符号表：名称与句柄的双向映射
+class SymbolTable {
+public:
+    SymbolTable();
+
+    void clear();
+    // 取得名称对应的句柄，不存在时分配新的编号
+    Symbol intern(const std::string& name, SymbolType type);
+    // 查找已有的符号，不存在时返回false
+    bool lookup(std::string_view name, SymbolType type, Symbol& symbol) const;
+    const std::string& name(Symbol symbol) const { return names[symbol.type()][symbol.index()]; }
+    // 某种符号已分配的编号个数，编号为 0 .. count-1
+    size_t count(SymbolType type) const { return names[type].size(); }
+
+private:
+    struct NameHash {
+        using is_transparent = void;
+        size_t operator()(std::string_view name) const { return std::hash<std::string_view>()(name); }
+    };
+    std::vector<std::string> names[4];  // 每种符号：编号 -> 名称
+    std::unordered_map<std::string, uint32_t, NameHash, std::equal_to<>> ids[4];  // 每种符号：名称 -> 编号
+};
+
+#endif //SD2_SYMBOL_H
@@ -2,8 +2,13 @@
 #define SD2_SYNTAXANALYZER_H
 
 #include "LR1Item.h"
+#include "ParseTable.h"
+#include "ParseTableFile.h"
+#include "GLRParser.h"
+#include "ParseTree.h"
 #include <map>
 #include <vector>
+#include <unordered_map>
 #include "LexicalAnalyzer.h"
 
 struct TokenInfo {
@@ -12,48 +17,204 @@ struct TokenInfo {
     int lineNumber;
 };// 词法分析器的Token信息结构体
 
+// 分析表的构造方式
+enum ConstructionMode {
+    CANONICAL_LR1,  // 规范LR(1)
+    LALR1,          // LALR(1)：LR(0)项目集 + 向前看符号传播
+    MINIMAL_LR1     // 最小LR(1)：只合并满足Pager弱相容条件的同心状态
+};
+
+// 构造分析表时发现的冲突：同一(状态, 符号)上出现的两个动作以及最终保留的动作
+struct TableConflict {
+    int state;
+    Symbol symbol;
+    std::string first;
+    std::string second;
+    std::string chosen;
+};
+
+// analyze的输出详细程度
+enum TraceLevel {
+    TRACE_NONE,     // 不输出分析过程，只报告错误
+    TRACE_SUMMARY,  // 记录分析过程，只输出结果和步数，之后可以用printTrace打印
+    TRACE_FULL      // 输出Token检查、First集、每一步的分析过程以及分析表和项目集
+};
+
+// 分析过程中一步的紧凑记录：当时的动作编码和输入位置，栈的内容在打印时重新执行得到
+struct TraceEvent {
+    int32_t action;
+    uint32_t inputPosition;
+};
+
+// analyze在移进和规约时调用的回调，与语义值的类型无关；SemanticActions<V>（见SemanticActions.h）用它维护类型化的值栈
+struct ReductionHooks {
+    void* context = nullptr;
+    void (*begin)(void* context, size_t tokenCount) = nullptr;          // 分析开始之前
+    void (*shift)(void* context, uint32_t tokenIndex) = nullptr;        // 移进第tokenIndex个Token
+    void (*reduce)(void* context, int production, int length) = nullptr;  // 按产生式规约，右部有length个符号
+    void (*discard)(void* context, int count) = nullptr;  // 错误恢复时弹出栈顶count个符号
+    void (*shiftError)(void* context) = nullptr;          // 错误恢复时移进error符号，或者压入当作已分析完毕的非终结符
+};
+
+// 分析中发现的语法错误
+struct SyntaxError {
+    int state;          // 出错时的状态
+    int terminal;       // 出错时的向前看终结符
+    size_t tokenIndex;  // 出错Token在输入中的下标，等于Token个数表示在输入末尾
+    int lineNumber;
+};
+
+// Token层面的一次编辑：上次分析的输入中从start开始的removed个Token，换成了新输入中从start开始的inserted个Token
+struct TokenEdit {
+    size_t start;
+    size_t removed;
+    size_t inserted;
+};
+
+// LR(1)状态的核心项目：点不在最左端的项目以及增广开始项目
+// 规范LR(1)中项目集的闭包由核心唯一确定，查找重复状态只需比较核心
+struct KernelItem {
+    int production;
+    size_t dotPosition;
+    TerminalSet lookahead;
+
+    bool operator==(const KernelItem& other) const {
+        return production == other.production && dotPosition == other.dotPosition && lookahead == other.lookahead;
+    }
+};
+using StateKernel = std::vector<KernelItem>;  // 按项目集中的顺序排列，同一项目集得到同一序列
+
+struct StateKernelHash {
+    size_t operator()(const StateKernel& kernel) const;
+};
+
 class SyntaxAnalyzer {
 public:
     SyntaxAnalyzer();
+    // tableView可能指向自身的parseTable或mappedTable，glrParser引用tableView和multiActions，复制后会指向原对象，因此不可复制
+    SyntaxAnalyzer(const SyntaxAnalyzer&) = delete;
+    SyntaxAnalyzer& operator=(const SyntaxAnalyzer&) = delete;
+
+    void setConstructionMode(ConstructionMode mode) { constructionMode = mode; } // 在loadGrammar之前设置构造方式
+    void setBuildThreads(unsigned threads) { buildThreads = threads; } // 规范LR(1)构造使用的线程数，大于1时并行构造
+    void setTraceLevel(TraceLevel level) { traceLevel = level; }     // analyze的输出详细程度，默认不输出分析过程
+    void setBuildTree(bool build) { buildTree = build; }             // analyze时是否构造语法树，默认不构造
+    // 一次分析最多报告的语法错误数，默认为1即遇到第一个错误就停止；大于1时出错后做恐慌模式的错误恢复
+    void setMaxErrors(size_t count) { maxErrors = count; }
+    // 错误恢复的同步Token：文法中没有可用的error产生式时，跳过输入直到其中之一再继续分析；
+    // 栈中没有状态能处理该Token时把它也跳过，从它后面的Token继续
+    void setSyncTokens(const std::vector<std::string>& names) { syncTokenNames = names; }
 
     bool loadGrammar(const std::string& filename);  // 加载文法文件，返回是否成功，对输入的语法信息进行规范化处理
+    // 映射由saveParseTable保存的分析表文件，文件与文法文件的内容和构造方式对应时才成功，之后可直接analyze
+    bool loadParseTable(const std::string& filename, const std::string& grammarFilename);
+    bool saveParseTable(const std::string& filename) const;  // 保存当前的分析表，供以后的运行直接映射
+    const ParseTableView& parseTableView() const { return tableView; }  // 当前使用的分析表，供代码生成等工具读取
     bool analyze(const std::vector<TokenInfo>& tokens); // 语法分析函数，接收Token信息的向量作为参数，执行主体的语法分析
+    bool analyze(const std::vector<TokenInfo>& tokens, const ReductionHooks& hooks);  // 分析的同时在每次移进和规约时调用hooks
+    // 增量分析：tokens是上次分析的输入经过edit后的结果，复用上次语法树中未受影响的子树，只重新分析编辑附近的部分。
+    // 总是构造语法树；不执行语义动作，也不记录分析过程。上次分析没有成功或者编辑与上次的输入对不上时完整地重新分析
+    bool reparse(const std::vector<TokenInfo>& tokens, const TokenEdit& edit);
+    // GLR分析：有冲突的表项保留全部动作，在图结构栈上分叉，结果为共享压缩分析森林，可用于有歧义的文法。
+    // 不执行语义动作，也不记录分析过程；分析表来自分析表文件时没有冲突信息，与analyze接受相同的语言
+    bool analyzeGLR(const std::vector<TokenInfo>& tokens);
     void outputResult(const std::string& filename) const; // 输出分析结果到文件中以备不时之需，目前该功能已被弃用，不再维护
     void printTokensAndFirstSets() const;  // 打印词法token和First集
     void printLR1Table() const;           // 打印LR(1)分析表
     void printItemSets() const;           // 打印LR(1)项目集
+    void printConflictReport();           // 打印冲突报告，合并状态的构造方式下与规范LR(1)对比，指出合并引入的冲突
+    void printTrace() const;              // 按最近一次analyze记录的事件打印分析过程，需要TRACE_SUMMARY或TRACE_FULL
+    // 最近一次分析得到的语法树，需要setBuildTree(true)。经error产生式恢复后接受的分析（返回false）也有语法树，
+    // 其中含有error叶子；按同步Token恢复或者没有接受时树为空。叶子在tokens中的下标由它左边各子树的tokenCount累加得到
+    const ParseTree& parseTree() const { return tree; }
+    const std::vector<SyntaxError>& syntaxErrors() const { return errors; }  // 最近一次分析报告的全部语法错误
+    void printParseTree(const std::vector<TokenInfo>& tokens) const;  // 打印语法树，tokens为分析时的输入
+    const SharedPackedForest& parseForest() const { return forest; }  // 最近一次成功的analyzeGLR得到的森林
+    void printParseForest(const std::vector<TokenInfo>& tokens) const;
 
 private:
+    ConstructionMode constructionMode = CANONICAL_LR1;
+    unsigned buildThreads = 1;
+    bool reportConstruction = true;  // 构造分析表时是否输出提示和冲突
+    TraceLevel traceLevel = TRACE_NONE;
+    std::vector<int> traceInput;           // 最近一次分析的输入（终结符编号，以#结尾）
+    std::vector<TraceEvent> traceEvents;   // 最近一次分析每一步的记录
+    bool buildTree = false;
+    ParseTree tree;                        // 多次分析共用同一块存储
+    bool treeReusable = false;             // tree来自一次没有错误的分析，与traceInput对应，可供reparse复用
+    bool analyzeWithTree(const std::vector<TokenInfo>& tokens);
+    size_t maxErrors = 1;
+    std::vector<std::string> syncTokenNames;
+    std::vector<SyntaxError> errors;
+    void printSyntaxError(const SyntaxError& error) const;
+    void printActionError(int state, int terminal) const;
+    void printGotoError(int state, int nonTerminal) const;
+    std::string grammarFile;
+    std::vector<TableConflict> conflicts;
+
+    SymbolTable symbols;           // 文法的符号表，符号只以句柄形式出现在其他数据结构中
+    std::vector<Symbol> rhsPool;   // 全部产生式右部连续存放，Production::right指向其中一段
     std::vector<Production> productions;
     std::set<Symbol> terminals;
     std::set<Symbol> nonTerminals;
-    std::map<int, std::set<LR1Item>> states;
+    std::map<int, std::set<LR1Item>> states;  // 各状态只保存核心项目，完整项目集在需要时由closure求出
     std::map<std::pair<int, Symbol>, std::string> actionTable;
     std::map<std::pair<int, Symbol>, int> gotoTable;
 
-    // First集合映射表：符号 -> First集合
-    std::map<Symbol, std::set<Symbol>> firstSets;
+    // 由actionTable/gotoTable编译得到的稠密整数分析表，或者映射的分析表文件；analyze只通过tableView访问
+    ParseTable parseTable;
+    MappedParseTable mappedTable;
+    ParseTableView tableView;
+    MultiActionTable multiActions;  // 由conflicts得到的冲突表项的全部动作，供GLR分析使用
+    GLRParser glrParser{tableView, multiActions};  // 图结构栈的存储在多次分析之间复用
+    SharedPackedForest forest;
+    uint64_t grammarHash = 0;  // 文法文本与构造方式的哈希，标识分析表文件
+    bool hashGrammarFile(const std::string& filename, uint64_t& hash) const;
+    std::map<Symbol, int> terminalIds;     // 终结符（包括#） -> 稠密编号，向前看符号集合也使用这个编号
+    std::vector<Symbol> terminalSymbols;   // 稠密编号 -> 终结符
+    std::map<Symbol, int> nonTerminalIds;  // 非终结符 -> 稠密编号
+    std::map<int, Symbol> tokenBindings;   // 文法中%bind指令给出的Token类型 -> 终结符
+
+    // 输入Token的分类：每个Token只查一次哈希表，名称不是终结符时再看Token类型的绑定
+    std::unordered_map<std::string_view, int> terminalByName;  // 键指向tableView中的名称数据
+    int errorTerminal = -1;  // 文法中的error终结符，只在错误恢复时移进，不与输入的Token匹配
+    void indexTerminalNames();
+    int classifyToken(const TokenInfo& token) const;
 
-    // First集合相关的辅助函数
-    void initializeFirstSets();
-    std::set<Symbol> getFirstOfSymbolSequence(const std::vector<Symbol>& symbols);
-    bool addToFirstSet(const Symbol& symbol, const Symbol& firstSymbol);
+    // 可空性与First/Follow集，按非终结符的编号（Symbol::index）存放，集合为终结符编号的位图
+    std::vector<char> nullable;
+    std::vector<TerminalSet> firstSets;
+    std::vector<TerminalSet> followSets;
 
-    // Follow集合映射表：符号 -> Follow集合
-    std::map<Symbol, std::set<Symbol>> followSets;
+    // First/Follow集合相关的辅助函数
+    void numberTerminals();
+    void computeNullable();
+    std::string formatTerminalSet(const TerminalSet& set, bool withEpsilon) const;
 
-    // Follow集合相关的辅助函数
-    void initializeFollowSets();
-    bool addToFollowSet(const Symbol& symbol, const Symbol& followSymbol);
-    bool addToFollowSet(const Symbol& symbol, const std::set<Symbol>& followSymbols);
+    // 求闭包用的索引：左部 -> 产生式编号，以及每个(产生式, 点位置)之后的符号串的First集和能否推导出ε
+    std::map<Symbol, std::vector<int>> productionsByLeft;
+    std::vector<std::vector<TerminalSet>> suffixFirstSets;
+    std::vector<std::vector<char>> suffixNullable;
+    void indexProductions();
 
     // 计算LR(1)分析表相关的辅助函数
     void computeFirstSets();
-    void computeFollowSets();
+    void computeFollowSets();  // 依赖First集
     void buildLR1Automaton();
+    void buildLR1AutomatonParallel();  // 在线程池上构造，结果与buildLR1Automaton相同
+    void buildLALR1Automaton();
+    void buildMinimalLR1Automaton();
     void constructParsingTables();
-    std::set<LR1Item> closure(const std::set<LR1Item>& items);
-    std::set<LR1Item> goTo(const std::set<LR1Item>& items, const Symbol& symbol);
+    std::set<std::pair<int, size_t>> lr0Closure(const std::set<std::pair<int, size_t>>& kernel) const;
+    void fillParsingTables(const std::map<std::pair<int, Symbol>, int>& transitions);
+    void emitReduction(int state, const LR1Item& item);
+    void emitTransition(int state, const Symbol& symbol, int target);
+    void setAction(int state, const Symbol& symbol, const std::string& action);
+    void compileParseTable();
+    std::set<LR1Item> closure(const std::set<LR1Item>& items) const;
+    static StateKernel kernelOf(const std::set<LR1Item>& items);
+    // 按下一个符号分组求全部后继状态的核心项目集（未求闭包），每个符号一项
+    std::vector<std::pair<Symbol, std::set<LR1Item>>> goToKernels(const std::set<LR1Item>& items) const;
 };
 
 #endif //SD2_SYNTAXANALYZER_H
\ No newline at end of file
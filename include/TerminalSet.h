@@ -0,0 +1,97 @@
+#ifndef SD2_TERMINALSET_H
+#define SD2_TERMINALSET_H
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// 终结符集合的位图表示：终结符按稠密编号对应到64位字中的一位，
+// 并集、相等比较和哈希都按字逐个处理，循环可以被编译器向量化，不再逐个比较符号名
+// 始终保持末尾没有全零的字，相同的集合有相同的表示
+class TerminalSet {
+public:
+    TerminalSet() = default;
+
+    bool insert(int id) {
+        size_t word = static_cast<size_t>(id) / 64;
+        if (word >= words.size()) words.resize(word + 1, 0);
+        uint64_t bit = uint64_t(1) << (id % 64);
+        bool added = (words[word] & bit) == 0;
+        words[word] |= bit;
+        return added;
+    }
+
+    bool erase(int id) {
+        size_t word = static_cast<size_t>(id) / 64;
+        if (word >= words.size()) return false;
+        uint64_t bit = uint64_t(1) << (id % 64);
+        bool removed = (words[word] & bit) != 0;
+        words[word] &= ~bit;
+        trim();
+        return removed;
+    }
+
+    bool contains(int id) const {
+        size_t word = static_cast<size_t>(id) / 64;
+        return word < words.size() && (words[word] >> (id % 64) & 1) != 0;
+    }
+
+    // 并入另一个集合，返回本集合是否增加了元素
+    bool merge(const TerminalSet& other) {
+        if (other.words.size() > words.size()) words.resize(other.words.size(), 0);
+        uint64_t added = 0;
+        for (size_t i = 0; i < other.words.size(); i++) {
+            added |= other.words[i] & ~words[i];
+            words[i] |= other.words[i];
+        }
+        return added != 0;
+    }
+
+    bool intersects(const TerminalSet& other) const {
+        size_t n = words.size() < other.words.size() ? words.size() : other.words.size();
+        for (size_t i = 0; i < n; i++) {
+            if (words[i] & other.words[i]) return true;
+        }
+        return false;
+    }
+
+    bool empty() const { return words.empty(); }
+
+    size_t size() const {
+        size_t count = 0;
+        for (uint64_t word : words) count += std::popcount(word);
+        return count;
+    }
+
+    // 按编号从小到大访问集合中的每个终结符
+    template <typename F>
+    void forEach(F&& visit) const {
+        for (size_t i = 0; i < words.size(); i++) {
+            for (uint64_t word = words[i]; word != 0; word &= word - 1) {
+                visit(static_cast<int>(i * 64 + std::countr_zero(word)));
+            }
+        }
+    }
+
+    size_t hash() const {
+        size_t seed = words.size();
+        for (uint64_t word : words) {
+            seed ^= static_cast<size_t>(word) + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2);
+        }
+        return seed;
+    }
+
+    bool operator==(const TerminalSet& other) const { return words == other.words; }
+    bool operator!=(const TerminalSet& other) const { return words != other.words; }
+    bool operator<(const TerminalSet& other) const { return words < other.words; }
+
+private:
+    std::vector<uint64_t> words;
+
+    void trim() {
+        while (!words.empty() && words.back() == 0) words.pop_back();
+    }
+};
+
+#endif //SD2_TERMINALSET_H
@@ -0,0 +1,55 @@
+#ifndef SD2_THREADPOOL_H
+#define SD2_THREADPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// 工作窃取线程池：每个工作线程有自己的任务双端队列，
+// 本线程从队尾取任务（后进先出，缓存友好），空闲时从其他线程的队首窃取任务
+class ThreadPool {
+public:
+    explicit ThreadPool(unsigned thread_count = std::thread::hardware_concurrency());
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // 提交任务；在工作线程内部提交时放入本线程队列，否则轮流分配到各队列
+    void submit(std::function<void()> task);
+
+    // 阻塞直到所有已提交的任务（包括任务中再提交的任务）执行完毕；
+    // 若有任务抛出异常，在此处重新抛出第一个异常
+    void wait();
+
+    unsigned size() const { return static_cast<unsigned>(workers.size()); }
+
+private:
+    struct WorkQueue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    std::vector<std::unique_ptr<WorkQueue>> queues;
+    std::vector<std::thread> workers;
+
+    std::mutex state_mutex;
+    std::condition_variable work_available;
+    std::condition_variable all_done;
+    size_t queued = 0;                 // 已入队但尚未被取走的任务数，受state_mutex保护
+    std::atomic<size_t> pending{0};    // 已提交但尚未执行完的任务数
+    std::atomic<unsigned> next_queue{0};
+    bool stopping = false;
+    std::exception_ptr first_error;
+
+    void workerLoop(unsigned index);
+    bool takeTask(unsigned index, std::function<void()>& task);
+};
+
+#endif //SD2_THREADPOOL_H